@@ -6,5 +6,7 @@
 #include "cobalt/ast/keyvals.hpp"
 #include "cobalt/ast/literals.hpp"
 #include "cobalt/ast/scope.hpp"
+#include "cobalt/ast/typedefs.hpp"
 #include "cobalt/ast/vars.hpp"
+#include "cobalt/ast/visitor.hpp"
 #endif
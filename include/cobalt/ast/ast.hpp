@@ -3,23 +3,31 @@
 #include "cobalt/context.hpp"
 #include "cobalt/support/sstring.hpp"
 #include "cobalt/support/location.hpp"
+#include "cobalt/support/hash.hpp"
+#include "cobalt/support/operators.hpp"
 #include "cobalt/typed_value.hpp"
 #define CO_INIT(ID) ID(std::move(ID))
 namespace cobalt {
   class AST;
   namespace ast {
     struct ast_base {
+      enum class kind_t {TOP_LEVEL, GROUP, BLOCK, IF, WHILE, FOR, BINOP, UNOP, CAST, CALL, SUBSCR, FNDEF, NULLVAL, INTEGER, FLOAT, STRING, CHAR, MODULE, IMPORT, VARDEF, MUTDEF, VARGET, STRUCTDEF, MEMBER};
+      const kind_t kind;
       location loc;
-      ast_base(sstring file, std::size_t line, std::size_t col) : loc{file, line, col} {}
-      ast_base(location loc) : loc(loc) {}
+      mutable type_ptr cached_type = nullptr; // set by annotate(), see sema.hpp
+      mutable bool annotated = false;
+      ast_base(sstring file, std::size_t line, std::size_t col, kind_t kind) : kind(kind), loc{file, line, col} {}
+      ast_base(location loc, kind_t kind) : kind(kind), loc(loc) {}
       virtual ~ast_base() noexcept = 0;
-      virtual bool is_const() const noexcept {return false;}
-      virtual bool eq(ast_base const* other) const = 0;
-      virtual typed_value codegen(compile_context& ctx = global) const = 0;
-      virtual type_ptr type(base_context& ctx = global) const = 0;
+      bool is_const() const noexcept {return kind == kind_t::NULLVAL || (kind >= kind_t::INTEGER && kind <= kind_t::CHAR);}
+      // these dispatch on kind to the node's own implementation, see visitor.hpp
+      bool eq(ast_base const* other) const;
+      std::size_t hash() const;
+      typed_value codegen(compile_context& ctx = global) const;
+      type_ptr type(base_context& ctx = global) const; // returns the annotation if there is one
       void print(llvm::raw_ostream& os) const {print_impl(os, "");}
     private:
-      virtual void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const = 0;
+      void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
       friend class ::cobalt::AST;
     protected:
       void print_self(llvm::raw_ostream& os, llvm::Twine name) const;
@@ -52,11 +60,12 @@ namespace cobalt {
     typed_value operator()(compile_context& ctx = global) const {return ptr ? ptr->codegen(ctx) : nullval;}
     type_ptr type(base_context& ctx = global) const {return ptr ? ptr->type(ctx) : nullptr;}
     void print(llvm::raw_ostream& os = llvm::outs()) const {if (ptr) ptr->print(os);}
-    bool operator==(AST const& other) const {return ptr ? (other && ptr->eq(other.ptr)) : !bool(other);}
+    std::size_t hash() const {return ptr ? ptr->hash() : 0;}
+    bool operator==(AST const& other) const {return ptr == other.ptr || (ptr && other && ptr->eq(other.ptr));}
     explicit operator bool() const noexcept {return (bool)ptr;}
     ast::ast_base* get() const noexcept {return ptr;}
     template <class T> T* cast() const {return ptr ? static_cast<T*>(ptr) : (T*)nullptr;}
-    template <class T> T* dyn_cast() const {return ptr ? dynamic_cast<T*>(ptr) : (T*)nullptr;}
+    template <class T> T* dyn_cast() const {return ptr && T::classof(ptr) ? static_cast<T*>(ptr) : (T*)nullptr;}
     template <class T, class... As> static AST create(As&&... args) {return new T(std::forward<As>(args)...);}
     template <class T, class... As> static AST create_nothrow(As&&... args) noexcept {
       ast::ast_base* ptr;
@@ -70,5 +79,40 @@ namespace cobalt {
       }
     }
   };
+  namespace ast {
+    template <class T> T const* ast_cast(ast_base const* ast) {return ast && T::classof(ast) ? static_cast<T const*>(ast) : nullptr;}
+    template <class T> T* ast_cast(ast_base* ast) {return ast && T::classof(ast) ? static_cast<T*>(ast) : nullptr;}
+    inline std::size_t hash_value(bool val) {return val;}
+    inline std::size_t hash_value(op_t val) {return val;}
+    inline std::size_t hash_value(double val) {return std::hash<double>{}(val);}
+    inline std::size_t hash_value(std::string_view val) {return std::hash<std::string_view>{}(val);}
+    inline std::size_t hash_value(AST const& val) {return val.hash();}
+    template <class A, class B> std::size_t hash_value(std::pair<A, B> const& val) {return hash_combine(hash_value(val.first), hash_value(val.second));}
+    template <class T> std::size_t hash_value(std::vector<T> const& val) {
+      std::size_t out = val.size();
+      for (auto const& elem : val) out = hash_combine(out, hash_value(elem));
+      return out;
+    }
+    template <class... Ts> std::size_t hash_node(ast_base::kind_t kind, Ts const&... parts) {
+      std::size_t out = static_cast<std::size_t>(kind);
+      ((out = hash_combine(out, hash_value(parts))), ...);
+      return out;
+    }
+    // for hash-consing or caching by content, e.g. std::unordered_map<AST, T, ast_hash, ast_eq>
+    struct ast_hash {
+      using is_transparent = void;
+      std::size_t operator()(AST const& ast) const {return ast.hash();}
+      std::size_t operator()(ast_base const* ast) const {return ast ? ast->hash() : 0;}
+    };
+    struct ast_eq {
+      using is_transparent = void;
+      static ast_base const* get(AST const& ast) {return ast.get();}
+      static ast_base const* get(ast_base const* ast) {return ast;}
+      template <class L, class R> bool operator()(L const& lhs, R const& rhs) const {
+        auto l = get(lhs), r = get(rhs);
+        return l == r || (l && r && l->eq(r));
+      }
+    };
+  }
 }
 #endif
@@ -1,61 +1,75 @@
 #ifndef COBALT_AST_FLOW_HPP
 #define COBALT_AST_FLOW_HPP
 #include "cobalt/ast/ast.hpp"
+#include "cobalt/support/token.hpp"
+#include "cobalt/support/span.hpp"
 namespace cobalt::ast {
   struct top_level_ast : ast_base {
+    struct chunk_info {
+      std::size_t hash, count; // hash of the statement's tokens, number of nodes in insts
+      std::size_t line;
+      span<token const> toks;
+    };
     std::vector<AST> insts;
-    top_level_ast(location loc, std::vector<AST>&& insts) : ast_base(loc), CO_INIT(insts) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<top_level_ast const*>(other)) return insts == ptr->insts; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    std::vector<chunk_info> chunks; // set by parse, used by reparse
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::TOP_LEVEL;}
+    top_level_ast(location loc, std::vector<AST>&& insts) : ast_base(loc, kind_t::TOP_LEVEL), CO_INIT(insts) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<top_level_ast>(other)) return insts == ptr->insts; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::TOP_LEVEL, insts);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct group_ast : ast_base {
     std::vector<AST> insts;
-    group_ast(location loc, std::vector<AST>&& insts) : ast_base(loc), CO_INIT(insts) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<group_ast const*>(other)) return insts == ptr->insts; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::GROUP;}
+    group_ast(location loc, std::vector<AST>&& insts) : ast_base(loc, kind_t::GROUP), CO_INIT(insts) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<group_ast>(other)) return insts == ptr->insts; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::GROUP, insts);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct block_ast : ast_base {
     std::vector<AST> insts;
-    block_ast(location loc, std::vector<AST>&& insts) : ast_base(loc), CO_INIT(insts) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<block_ast const*>(other)) return insts == ptr->insts; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::BLOCK;}
+    block_ast(location loc, std::vector<AST>&& insts) : ast_base(loc, kind_t::BLOCK), CO_INIT(insts) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<block_ast>(other)) return insts == ptr->insts; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::BLOCK, insts);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct if_ast : ast_base {
     AST cond, if_true, if_false;
-    if_ast(location loc, AST&& cond, AST&& if_true, AST&& if_false = nullptr) : ast_base(loc), CO_INIT(cond), CO_INIT(if_true), CO_INIT(if_false) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<if_ast const*>(other)) return cond == ptr->cond && if_true == ptr->if_true && if_false == ptr->if_false; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::IF;}
+    if_ast(location loc, AST&& cond, AST&& if_true, AST&& if_false = nullptr) : ast_base(loc, kind_t::IF), CO_INIT(cond), CO_INIT(if_true), CO_INIT(if_false) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<if_ast>(other)) return cond == ptr->cond && if_true == ptr->if_true && if_false == ptr->if_false; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::IF, cond, if_true, if_false);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct while_ast : ast_base {
     AST cond, body;
-    while_ast(location loc, AST&& cond, AST&& body) : ast_base(loc), CO_INIT(cond), CO_INIT(body) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<while_ast const*>(other)) return cond == ptr->cond && body == ptr->body; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::WHILE;}
+    while_ast(location loc, AST&& cond, AST&& body) : ast_base(loc, kind_t::WHILE), CO_INIT(cond), CO_INIT(body) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<while_ast>(other)) return cond == ptr->cond && body == ptr->body; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::WHILE, cond, body);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct for_ast : ast_base {
     AST cond, body;
     sstring elem_name;
-    for_ast(location loc, sstring elem_name, AST&& cond, AST&& body) : ast_base(loc), CO_INIT(cond), CO_INIT(body), elem_name(elem_name) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<while_ast const*>(other)) return cond == ptr->cond && body == ptr->body; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::FOR;}
+    for_ast(location loc, sstring elem_name, AST&& cond, AST&& body) : ast_base(loc, kind_t::FOR), CO_INIT(cond), CO_INIT(body), elem_name(elem_name) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<for_ast>(other)) return elem_name == ptr->elem_name && cond == ptr->cond && body == ptr->body; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::FOR, elem_name, cond, body);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
 }
 #endif
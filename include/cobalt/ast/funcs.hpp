@@ -2,68 +2,98 @@
 #define COBALT_AST_FUNCS_HPP
 #include "cobalt/ast/ast.hpp"
 #include "cobalt/types/types.hpp"
+#include "cobalt/support/token.hpp"
+#include "cobalt/support/span.hpp"
 namespace cobalt::ast {
   struct binop_ast : ast_base {
-    sstring op;
+    op_t op;
     AST lhs, rhs;
-    binop_ast(location loc, sstring op, AST&& lhs, AST&& rhs) : ast_base(loc), op(op), CO_INIT(lhs), CO_INIT(rhs) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<binop_ast const*>(other)) return op == ptr->op && lhs == ptr->lhs && rhs == ptr->rhs; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::BINOP;}
+    binop_ast(location loc, op_t op, AST&& lhs, AST&& rhs) : ast_base(loc, kind_t::BINOP), op(op), CO_INIT(lhs), CO_INIT(rhs) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<binop_ast>(other)) return op == ptr->op && lhs == ptr->lhs && rhs == ptr->rhs; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::BINOP, op, lhs, rhs);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct unop_ast : ast_base {
-    sstring op;
+    op_t op;
     AST val;
-    unop_ast(location loc, sstring op, AST&& val) : ast_base(loc), op(op), CO_INIT(val) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<unop_ast const*>(other)) return op == ptr->op && val == ptr->val; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::UNOP;}
+    unop_ast(location loc, op_t op, AST&& val) : ast_base(loc, kind_t::UNOP), op(op), CO_INIT(val) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<unop_ast>(other)) return op == ptr->op && val == ptr->val; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::UNOP, op, val);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct cast_ast : ast_base {
     sstring target;
     AST val;
-    cast_ast(location loc, sstring target, AST val) : ast_base(loc), target(target), CO_INIT(val) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<cast_ast const*>(other)) return target == ptr->target && val == ptr->val; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::CAST;}
+    cast_ast(location loc, sstring target, AST val) : ast_base(loc, kind_t::CAST), target(target), CO_INIT(val) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<cast_ast>(other)) return target == ptr->target && val == ptr->val; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::CAST, target, val);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct call_ast : ast_base {
     AST val;
     std::vector<AST> args;
-    call_ast(location loc, AST val, std::vector<AST>&& args) : ast_base(loc), CO_INIT(val), CO_INIT(args) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<call_ast const*>(other)) return val == ptr->val && args == ptr->args; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::CALL;}
+    call_ast(location loc, AST val, std::vector<AST>&& args) : ast_base(loc, kind_t::CALL), CO_INIT(val), CO_INIT(args) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<call_ast>(other)) return val == ptr->val && args == ptr->args; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::CALL, val, args);}
+    type_ptr construct_type(base_context& ctx) const; // if val names a type, then this constructs a value of it
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct subscr_ast : ast_base {
     AST val;
     std::vector<AST> args;
-    subscr_ast(location loc, AST val, std::vector<AST>&& args) : ast_base(loc), CO_INIT(val), CO_INIT(args) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<call_ast const*>(other)) return val == ptr->val && args == ptr->args; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::SUBSCR;}
+    subscr_ast(location loc, AST val, std::vector<AST>&& args) : ast_base(loc, kind_t::SUBSCR), CO_INIT(val), CO_INIT(args) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<subscr_ast>(other)) return val == ptr->val && args == ptr->args; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::SUBSCR, val, args);}
+    std::vector<type_ptr> type_args(base_context& ctx) const; // the arguments as type names, for explicit instantiations like f[i32], or an empty vector if one isn't a type
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
+  };
+  // field access on an expression that isn't a plain name, like f().x or xs[i].x, dotted names are handled by varget_ast
+  struct member_ast : ast_base {
+    AST val;
+    sstring field;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::MEMBER;}
+    member_ast(location loc, AST val, sstring field) : ast_base(loc, kind_t::MEMBER), CO_INIT(val), field(field) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<member_ast>(other)) return val == ptr->val && field == ptr->field; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::MEMBER, val, field);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct fndef_ast : ast_base {
     sstring name, ret;
     std::vector<std::pair<sstring, sstring>> args;
-    AST body;
+    mutable AST body;
     std::vector<std::string> annotations;
-    fndef_ast(location loc, sstring name, sstring ret, std::vector<std::pair<sstring, sstring>>&& args, AST&& body, std::vector<std::string>&& annotations) : ast_base(loc), name(name), ret(ret), CO_INIT(args), CO_INIT(body), CO_INIT(annotations) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<fndef_ast const*>(other)) return name == ptr->name && args == ptr->args; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    std::vector<sstring> tparams; // generic functions are instantiated for each list of type arguments they're used with
+    span<token> body_toks; // unparsed body, the tokens and error handler must outlive the AST
+    flags_t body_flags;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::FNDEF;}
+    fndef_ast(location loc, sstring name, sstring ret, std::vector<std::pair<sstring, sstring>>&& args, AST&& body, std::vector<std::string>&& annotations, std::vector<sstring>&& tparams = {}) : ast_base(loc, kind_t::FNDEF), name(name), ret(ret), CO_INIT(args), CO_INIT(body), CO_INIT(annotations), CO_INIT(tparams) {}
+    fndef_ast(location loc, sstring name, sstring ret, std::vector<std::pair<sstring, sstring>>&& args, span<token> body_toks, flags_t body_flags, std::vector<std::string>&& annotations, std::vector<sstring>&& tparams = {}) : ast_base(loc, kind_t::FNDEF), name(name), ret(ret), CO_INIT(args), body(nullptr), CO_INIT(annotations), CO_INIT(tparams), body_toks(body_toks), body_flags(body_flags) {}
+    bool body_parsed() const noexcept {return body || body_toks.empty();}
+    AST const& get_body() const; // parses the body on first access, not thread-safe
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<fndef_ast>(other)) return name == ptr->name && ret == ptr->ret && args == ptr->args && get_body() == ptr->get_body() && annotations == ptr->annotations && tparams == ptr->tparams; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::FNDEF, name, ret, args, get_body(), annotations, tparams);}
+    std::vector<type_ptr> deduce(std::vector<type_ptr> const& args_t) const; // type arguments for a call with arguments of these types, or an empty vector if they can't be deduced
+    type_ptr instance_type(std::vector<type_ptr> const& targs, base_context& ctx) const; // the function type of an instance, with the type parameters bound in the current scope
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
 }
 #endif
@@ -3,13 +3,13 @@
 #include "cobalt/ast/ast.hpp"
 namespace cobalt::ast {
   struct null_ast : ast_base {
-    null_ast(location loc) : ast_base(loc) {}
-    bool is_const() const noexcept override {return true;}
-    bool eq(ast_base const* other) const override {return typeid(other) == typeid(null_ast const*);}
-    typed_value codegen(compile_context& ctx = global) const override;
-    type_ptr type(base_context& ctx = global) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::NULLVAL;}
+    null_ast(location loc) : ast_base(loc, kind_t::NULLVAL) {}
+    bool eq(ast_base const* other) const {return other->kind == kind_t::NULLVAL;}
+    std::size_t hash() const {return hash_node(kind_t::NULLVAL);}
+    typed_value codegen(compile_context& ctx = global) const;
+    type_ptr type(base_context& ctx = global) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
 }
 #endif
\ No newline at end of file
@@ -5,46 +5,50 @@
 namespace cobalt::ast {
   struct literal_ast : ast_base {
     sstring suffix;
-    literal_ast(location loc, sstring suffix) : ast_base(loc), suffix(suffix) {}
-    bool is_const() const noexcept override {return true;}
+    static bool classof(ast_base const* ast) {return ast->kind >= kind_t::INTEGER && ast->kind <= kind_t::CHAR;}
+    literal_ast(location loc, kind_t kind, sstring suffix) : ast_base(loc, kind), suffix(suffix) {}
     ~literal_ast();
   };
   inline literal_ast::~literal_ast() {}
   struct integer_ast : literal_ast {
     llvm::APInt val;
-    integer_ast(location loc, llvm::APInt val, sstring suffix) : literal_ast(loc, suffix), val(std::move(val)) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<integer_ast const*>(other)) return suffix == ptr->suffix && val == ptr->val; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::INTEGER;}
+    integer_ast(location loc, llvm::APInt val, sstring suffix) : literal_ast(loc, kind_t::INTEGER, suffix), val(std::move(val)) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<integer_ast>(other)) return suffix == ptr->suffix && val == ptr->val; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::INTEGER, suffix, val);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct float_ast : literal_ast {
     double val;
-    float_ast(location loc, double val, sstring suffix) : literal_ast(loc, suffix), val(val) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<float_ast const*>(other)) return suffix == ptr->suffix && val == ptr->val; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::FLOAT;}
+    float_ast(location loc, double val, sstring suffix) : literal_ast(loc, kind_t::FLOAT, suffix), val(val) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<float_ast>(other)) return suffix == ptr->suffix && val == ptr->val; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::FLOAT, suffix, val);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct string_ast : literal_ast {
     std::string val;
-    string_ast(location loc, std::string&& val, sstring suffix) : literal_ast(loc, suffix), val(std::move(val)) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<string_ast const*>(other)) return suffix == ptr->suffix && val == ptr->val; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::STRING;}
+    string_ast(location loc, std::string&& val, sstring suffix) : literal_ast(loc, kind_t::STRING, suffix), val(std::move(val)) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<string_ast>(other)) return suffix == ptr->suffix && val == ptr->val; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::STRING, suffix, val);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct char_ast : literal_ast {
     std::string val; // string for multibyte chars
-    char_ast(location loc, std::string&& val, sstring suffix) : literal_ast(loc, suffix), val(std::move(val)) {}
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<char_ast const*>(other)) return suffix == ptr->suffix && val == ptr->val; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::CHAR;}
+    char_ast(location loc, std::string&& val, sstring suffix) : literal_ast(loc, kind_t::CHAR, suffix), val(std::move(val)) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<char_ast>(other)) return suffix == ptr->suffix && val == ptr->val; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::CHAR, suffix, val);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
 }
 #endif
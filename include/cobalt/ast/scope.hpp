@@ -5,23 +5,25 @@ namespace cobalt::ast {
   struct module_ast : ast_base {
     std::string name;
     std::vector<AST> insts;
-    module_ast(location loc, std::string&& name, std::vector<AST>&& insts) : ast_base(loc), CO_INIT(name), CO_INIT(insts) {}
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::MODULE;}
+    module_ast(location loc, std::string&& name, std::vector<AST>&& insts) : ast_base(loc, kind_t::MODULE), CO_INIT(name), CO_INIT(insts) {}
     ~module_ast();
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<module_ast const*>(other)) return name == ptr->name && insts == ptr->insts; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<module_ast>(other)) return name == ptr->name && insts == ptr->insts; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::MODULE, name, insts);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   struct import_ast : ast_base {
     std::string path;
-    import_ast(location loc, std::string&& path) : ast_base(loc), CO_INIT(path) {}
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::IMPORT;}
+    import_ast(location loc, std::string&& path) : ast_base(loc, kind_t::IMPORT), CO_INIT(path) {}
     ~import_ast();
-    bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<import_ast const*>(other)) return path == ptr->path; else return false;}
-    typed_value codegen(compile_context& ctx) const override;
-    type_ptr type(base_context& ctx) const override;
-  private:
-    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<import_ast>(other)) return path == ptr->path; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::IMPORT, path);}
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
   };
   inline module_ast::~module_ast() {}
   inline import_ast::~import_ast() {}
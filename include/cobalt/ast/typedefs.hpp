@@ -0,0 +1,27 @@
+#ifndef COBALT_AST_TYPEDEFS_HPP
+#define COBALT_AST_TYPEDEFS_HPP
+#include "cobalt/ast/ast.hpp"
+#include "cobalt/types/types.hpp"
+namespace cobalt::ast {
+  struct structdef_ast : ast_base {
+    struct field {
+      sstring name, type;
+      std::vector<std::string> annotations;
+      bool operator==(field const& other) const = default;
+      friend std::size_t hash_value(field const& f) {return hash_combine(hash_combine(hash_value(f.name), hash_value(f.type)), hash_value(f.annotations));}
+    };
+    sstring name;
+    std::vector<field> fields; // in declaration order
+    std::vector<std::string> annotations;
+    static bool classof(ast_base const* ast) {return ast->kind == kind_t::STRUCTDEF;}
+    structdef_ast(location loc, sstring name, std::vector<field>&& fields, std::vector<std::string>&& annotations) : ast_base(loc, kind_t::STRUCTDEF), name(name), CO_INIT(fields), CO_INIT(annotations) {}
+    bool eq(ast_base const* other) const {if (auto ptr = ast_cast<structdef_ast>(other)) return name == ptr->name && fields == ptr->fields && annotations == ptr->annotations; else return false;}
+    std::size_t hash() const {return hash_node(kind_t::STRUCTDEF, name, fields, annotations);}
+    // the type this defines, or null if a field's type or the layout is invalid, errors are only reported if diagnose is set
+    type_ptr struct_type(base_context& ctx, bool diagnose = false) const;
+    typed_value codegen(compile_context& ctx) const;
+    type_ptr type(base_context& ctx) const;
+    void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
+  };
+}
+#endif
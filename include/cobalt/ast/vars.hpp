@@ -8,33 +8,36 @@ namespace cobalt {
       AST val;
       bool global;
       std::vector<std::string> annotations = {};
-      vardef_ast(location loc, sstring name, AST&& val, bool global = false, std::vector<std::string>&& annotations = {}) : ast_base(loc), name(name), CO_INIT(val), global(global), CO_INIT(annotations) {}
-      bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<vardef_ast const*>(other)) return name == ptr->name && val == ptr->val; else return false;}
-      typed_value codegen(compile_context& ctx) const override;
-      type_ptr type(base_context& ctx) const override;
-    private: 
-      void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+      static bool classof(ast_base const* ast) {return ast->kind == kind_t::VARDEF;}
+      vardef_ast(location loc, sstring name, AST&& val, bool global = false, std::vector<std::string>&& annotations = {}) : ast_base(loc, kind_t::VARDEF), name(name), CO_INIT(val), global(global), CO_INIT(annotations) {}
+      bool eq(ast_base const* other) const {if (auto ptr = ast_cast<vardef_ast>(other)) return name == ptr->name && val == ptr->val && global == ptr->global && annotations == ptr->annotations; else return false;}
+      std::size_t hash() const {return hash_node(kind_t::VARDEF, name, val, global, annotations);}
+      typed_value codegen(compile_context& ctx) const;
+      type_ptr type(base_context& ctx) const;
+      void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
     };
     struct mutdef_ast : ast_base {
       sstring name;
       AST val;
       bool global;
       std::vector<std::string> annotations = {};
-      mutdef_ast(location loc, sstring name, AST&& val, bool global = false, std::vector<std::string>&& annotations = {}) : ast_base(loc), name(name), CO_INIT(val), global(global), CO_INIT(annotations) {}
-      bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<mutdef_ast const*>(other)) return name == ptr->name && val == ptr->val; else return false;}
-      typed_value codegen(compile_context& ctx) const override;
-      type_ptr type(base_context& ctx) const override;
-    private: 
-      void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+      static bool classof(ast_base const* ast) {return ast->kind == kind_t::MUTDEF;}
+      mutdef_ast(location loc, sstring name, AST&& val, bool global = false, std::vector<std::string>&& annotations = {}) : ast_base(loc, kind_t::MUTDEF), name(name), CO_INIT(val), global(global), CO_INIT(annotations) {}
+      bool eq(ast_base const* other) const {if (auto ptr = ast_cast<mutdef_ast>(other)) return name == ptr->name && val == ptr->val && global == ptr->global && annotations == ptr->annotations; else return false;}
+      std::size_t hash() const {return hash_node(kind_t::MUTDEF, name, val, global, annotations);}
+      typed_value codegen(compile_context& ctx) const;
+      type_ptr type(base_context& ctx) const;
+      void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
     };
     struct varget_ast : ast_base {
       sstring name;
-      varget_ast(location loc, sstring name) : ast_base(loc), name(name) {}
-      bool eq(ast_base const* other) const override {if (auto ptr = dynamic_cast<varget_ast const*>(other)) return name == ptr->name; else return false;}
-      typed_value codegen(compile_context& ctx) const override;
-      type_ptr type(base_context& ctx) const override;
-    private: 
-      void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const override;
+      static bool classof(ast_base const* ast) {return ast->kind == kind_t::VARGET;}
+      varget_ast(location loc, sstring name) : ast_base(loc, kind_t::VARGET), name(name) {}
+      bool eq(ast_base const* other) const {if (auto ptr = ast_cast<varget_ast>(other)) return name == ptr->name; else return false;}
+      std::size_t hash() const {return hash_node(kind_t::VARGET, name);}
+      typed_value codegen(compile_context& ctx) const;
+      type_ptr type(base_context& ctx) const;
+      void print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const;
     };
   }
 }
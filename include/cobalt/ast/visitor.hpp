@@ -0,0 +1,91 @@
+#ifndef COBALT_AST_VISITOR_HPP
+#define COBALT_AST_VISITOR_HPP
+#include "cobalt/ast/ast.hpp"
+#include "cobalt/ast/flow.hpp"
+#include "cobalt/ast/funcs.hpp"
+#include "cobalt/ast/keyvals.hpp"
+#include "cobalt/ast/literals.hpp"
+#include "cobalt/ast/scope.hpp"
+#include "cobalt/ast/typedefs.hpp"
+#include "cobalt/ast/vars.hpp"
+#include <llvm/Support/ErrorHandling.h>
+namespace cobalt::ast {
+  // call fn with node cast to its concrete type, switching on the kind tag
+  template <class N, class F> decltype(auto) visit(N& node, F&& fn) requires std::is_same_v<std::remove_const_t<N>, ast_base> {
+    constexpr bool is_const = std::is_const_v<N>;
+#define CO_VISIT(KIND, TYPE) case ast_base::kind_t::KIND: return fn(static_cast<std::conditional_t<is_const, TYPE const&, TYPE&>>(node));
+    switch (node.kind) {
+      CO_VISIT(TOP_LEVEL, top_level_ast)
+      CO_VISIT(GROUP, group_ast)
+      CO_VISIT(BLOCK, block_ast)
+      CO_VISIT(IF, if_ast)
+      CO_VISIT(WHILE, while_ast)
+      CO_VISIT(FOR, for_ast)
+      CO_VISIT(BINOP, binop_ast)
+      CO_VISIT(UNOP, unop_ast)
+      CO_VISIT(CAST, cast_ast)
+      CO_VISIT(CALL, call_ast)
+      CO_VISIT(SUBSCR, subscr_ast)
+      CO_VISIT(FNDEF, fndef_ast)
+      CO_VISIT(NULLVAL, null_ast)
+      CO_VISIT(INTEGER, integer_ast)
+      CO_VISIT(FLOAT, float_ast)
+      CO_VISIT(STRING, string_ast)
+      CO_VISIT(CHAR, char_ast)
+      CO_VISIT(MODULE, module_ast)
+      CO_VISIT(IMPORT, import_ast)
+      CO_VISIT(VARDEF, vardef_ast)
+      CO_VISIT(MUTDEF, mutdef_ast)
+      CO_VISIT(VARGET, varget_ast)
+      CO_VISIT(STRUCTDEF, structdef_ast)
+      CO_VISIT(MEMBER, member_ast)
+    }
+#undef CO_VISIT
+    llvm_unreachable("invalid AST node kind");
+  }
+  // call fn on each direct child of node, in source order
+  // unparsed function bodies are skipped, use fndef_ast::get_body() to parse them
+  template <class N, class F> void for_each_child(N& node, F&& fn) requires std::is_same_v<std::remove_const_t<N>, ast_base> {
+    visit(node, [&fn] <class T> (T& n) {
+      if constexpr (requires {n.insts;}) for (auto& ast : n.insts) fn(ast);
+      if constexpr (requires {n.cond;}) fn(n.cond);
+      if constexpr (requires {n.if_true;}) {
+        fn(n.if_true);
+        fn(n.if_false);
+      }
+      if constexpr (requires {n.lhs;}) {
+        fn(n.lhs);
+        fn(n.rhs);
+      }
+      if constexpr (requires {n.val;}) {if constexpr (std::is_same_v<decltype(n.val), AST>) fn(n.val);}
+      if constexpr (requires {n.args;}) {if constexpr (std::is_same_v<decltype(n.args), std::vector<AST>>) for (auto& ast : n.args) fn(ast);}
+      if constexpr (requires {n.body;}) {
+        if constexpr (std::is_same_v<std::remove_const_t<T>, fndef_ast>) {if (n.body_parsed()) fn(n.body);}
+        else fn(n.body);
+      }
+    });
+  }
+  // CRTP base for passes, Self provides visit_node overloads for the node types, a template overload can be used as a fallback
+  template <class Self, class R = void> struct visitor {
+    R operator()(AST const& ast) {return ast ? (*this)(*ast.get()) : static_cast<Self*>(this)->visit_null();}
+    R operator()(ast_base const& node) {return visit(node, [this] (auto const& n) -> R {return static_cast<Self*>(this)->visit_node(n);});}
+    R visit_null() {return R();}
+  };
+  namespace impl {
+    // if a node doesn't define one of these, the call would resolve to ast_base's and recurse forever
+    template <class T> constexpr bool overrides =
+      std::is_same_v<decltype(&T::eq), bool (T::*)(ast_base const*) const> &&
+      std::is_same_v<decltype(&T::hash), std::size_t (T::*)() const> &&
+      std::is_same_v<decltype(&T::codegen), typed_value (T::*)(compile_context&) const> &&
+      std::is_same_v<decltype(&T::type), type_ptr (T::*)(base_context&) const> &&
+      std::is_same_v<decltype(&T::print_impl), void (T::*)(llvm::raw_ostream&, llvm::Twine) const>;
+  }
+#define CO_CHECK(T) static_assert(impl::overrides<T>, #T " must define all of the node methods");
+  inline bool ast_base::eq(ast_base const* other) const {return visit(*this, [other] <class T> (T const& n) {CO_CHECK(T) return n.eq(other);});}
+  inline std::size_t ast_base::hash() const {return visit(*this, [] <class T> (T const& n) {CO_CHECK(T) return n.hash();});}
+  inline typed_value ast_base::codegen(compile_context& ctx) const {return visit(*this, [&ctx] <class T> (T const& n) {CO_CHECK(T) return n.codegen(ctx);});}
+  inline type_ptr ast_base::type(base_context& ctx) const {if (annotated) return cached_type; return visit(*this, [&ctx] <class T> (T const& n) {CO_CHECK(T) return n.type(ctx);});}
+  inline void ast_base::print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const {visit(*this, [&os, &prefix] <class T> (T const& n) {CO_CHECK(T) n.print_impl(os, prefix);});}
+#undef CO_CHECK
+}
+#endif
@@ -3,5 +3,8 @@
 #include "cobalt/tokenizer.hpp"
 #include "cobalt/parser.hpp"
 #include "cobalt/ast.hpp"
+#include "cobalt/serialize.hpp"
+#include "cobalt/sema.hpp"
+#include "cobalt/fold.hpp"
 #include "cobalt/context.hpp"
 #endif
\ No newline at end of file
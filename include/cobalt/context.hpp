@@ -5,18 +5,92 @@
 #include <llvm/IR/IRBuilder.h>
 #include "cobalt/flags.hpp"
 #include "cobalt/varmap.hpp"
+#include "cobalt/support/qpath.hpp"
+#include <map>
+#include <tuple>
 namespace cobalt {
+  namespace ast {struct fndef_ast;}
   struct base_context {
-    varmap* vars;
+    varmap* vars; // current module
+    symbol_table locals; // function and block scopes, these shadow vars
     flags_t flags;
     std::vector<std::string_view> path = {};
+    std::unordered_map<sstring, type_ptr> type_cache; // types that only name builtins, these are the same everywhere
+    scope_stamp visible; // lookups only see what the modules had at this point, set while generating a deferred body
+    // results of resolve for names that don't start in a local scope, keyed by the module the lookup started from and the cutoff
+    using resolve_key = std::tuple<varmap const*, qpath const*, std::size_t>;
+    struct resolve_key_hash {
+      std::size_t operator()(resolve_key const& val) const noexcept {
+        std::size_t out = (uintptr_t)std::get<0>(val);
+        out ^= (uintptr_t)std::get<1>(val) + 0x9e3779b9 + (out << 6) + (out >> 2);
+        out ^= std::get<2>(val) + 0x9e3779b9 + (out << 6) + (out >> 2);
+        return out;
+      }
+    };
+    mutable std::unordered_map<resolve_key, symbol_ptr, resolve_key_hash> resolve_cache;
+    mutable scope_stamp resolve_gen; // clock of the tree that resolve_cache was last valid for
+    // types that name something defined in a module, keyed by the module the lookup started from and the cutoff
+    using type_key = std::tuple<varmap const*, sstring, std::size_t>;
+    struct type_key_hash {
+      std::size_t operator()(type_key const& val) const noexcept {
+        std::size_t out = (uintptr_t)std::get<0>(val);
+        out ^= std::hash<sstring>{}(std::get<1>(val)) + 0x9e3779b9 + (out << 6) + (out >> 2);
+        out ^= std::get<2>(val) + 0x9e3779b9 + (out << 6) + (out >> 2);
+        return out;
+      }
+    };
+    struct scoped_type {
+      type_ptr type;
+      llvm::SmallVector<sstring, 1> names; // unqualified names it was resolved from, it's only valid while no local shadows them
+    };
+    std::unordered_map<type_key, scoped_type, type_key_hash> scoped_type_cache;
+    scope_stamp scoped_type_gen; // clock of the tree that scoped_type_cache was last valid for
     base_context(varmap* vars, flags_t flags = default_flags) : vars(vars), flags(flags) {}
+    // where the names in a type come from, which decides how long it can be cached
+    enum class type_scope {SESSION, MODULE, LOCAL};
+    type_ptr parse_type(sstring name); // resolve a type name, results are cached unless it names something local
+    symbol_ptr lookup(sstring name) const {if (auto ptr = locals.get(name, visible)) return ptr; return vars->get(name, visible);}
+    // look up a dotted name, the first component can be local unless the name starts with a dot
+    // on failure, *fail is set to the length of the prefix that's missing or isn't a module
+    symbol_ptr resolve(qpath const& path, std::size_t* fail = nullptr) const;
+    symbol_ptr resolve(std::string_view name, std::size_t* fail = nullptr) const {return resolve(*qpath::get(sstring::get(name)), fail);}
+    symbol_ptr resolve(sstring name, std::size_t* fail = nullptr) const {return resolve(*qpath::get(name), fail);}
+    // like resolve, but the name can also be a variable followed by field names, nvar is set to the number of segments that name the symbol
+    symbol_ptr resolve_var(qpath const& path, std::size_t& nvar, std::size_t* fail = nullptr) const;
+    bool define(sstring name, symbol_type sym) {return locals.depth() ? locals.insert(name, std::move(sym)) : vars->insert(name, std::move(sym));}
+  private:
+    // parse name without the caches, recording how far its meaning reaches and the module names it depends on
+    type_ptr parse_type(std::string_view name, type_scope& scope, llvm::SmallVectorImpl<sstring>& names);
   };
   struct compile_context : base_context {
     std::unique_ptr<llvm::LLVMContext> context;
     std::unique_ptr<llvm::Module> module;
     llvm::IRBuilder<> builder;
     unsigned init_count = 0;
+    bool runtime_init = false; // set once a global has to be initialized at startup, later initializers could see its side effects so they aren't run at compile time
+    // values that own heap memory, which is copied when they get another owner and freed when their owner dies
+    std::vector<std::pair<typed_value, std::size_t>> owned; // owned by the current function's locals, with the scope depth they were defined at, mutable ones are references to their storage
+    std::vector<typed_value> temps; // not owned by anything yet, these are freed at the end of the statement that made them
+    // generic functions are instantiated in the scope they were defined in, each instance is only generated once per module
+    struct generic_scope {
+      varmap* vars;
+      std::vector<std::string_view> path;
+      bool local; // local generics can see the locals of the function they were defined in
+    };
+    using instance_key = std::pair<ast::fndef_ast const*, std::vector<type_ptr>>;
+    std::unordered_map<ast::fndef_ast const*, generic_scope> generics;
+    std::map<instance_key, typed_value> instances;
+    instance_key const* instantiating = nullptr; // the instance whose definition is being generated
+    // with flags.demand_codegen, top-level function bodies are only generated once something uses their declarations
+    // they're generated as they would have been where they were defined, so they can't see anything defined after that
+    struct deferred_fn {
+      ast::fndef_ast const* def;
+      llvm::Function* fn;
+      type_ptr type;
+      generic_scope scope;
+      scope_stamp visible; // its module tree right after the function was declared
+    };
+    std::unordered_map<llvm::Function const*, deferred_fn> deferred;
     explicit compile_context(std::string const& name, flags_t flags = default_flags) : base_context(new varmap, flags), context(std::make_unique<llvm::LLVMContext>()), module(std::make_unique<llvm::Module>(name, *context)), builder(*context) {}
   };
   inline compile_context global{"<anonymous>"};
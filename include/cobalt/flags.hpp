@@ -6,6 +6,10 @@ namespace cobalt {
     bool name_escapes = false; // "\N{LATIN CAPITAL LETTER A}" == "A"
     bool warn_whitespace = true; // warns if source includes weird whitespace characters like U+00A0
     bool update_location = true; // 
+    std::size_t parse_threads = 0; // threads used to parse top-level declarations, 0 uses the hardware concurrency
+    bool lazy_bodies = false; // only scan the brackets of top-level function bodies, they are parsed on first access
+    bool bounds_checks = true; // trap on out-of-bounds array and slice subscripts, checks that are provably in bounds are removed
+    bool demand_codegen = false; // only generate function bodies reachable from main and @export, @link or @linkas definitions
     error_handler onerror = default_handler;
   };
   inline flags_t default_flags;
@@ -0,0 +1,11 @@
+#ifndef COBALT_FOLD_HPP
+#define COBALT_FOLD_HPP
+#include "cobalt/ast/ast.hpp"
+namespace cobalt {
+  // fold constant subexpressions, substitute let constants, and remove identities like x * 1, x + 0 and !!b
+  // this should run after annotate(), identities are only applied to annotated nodes when they don't change the type
+  // literals use the same promotion rules as get_binary, and otherwise fold to the same values that codegen would produce
+  // unparsed function bodies are skipped
+  void fold(AST& ast, base_context& ctx);
+}
+#endif
@@ -0,0 +1,14 @@
+#ifndef COBALT_OPTIMIZE_HPP
+#define COBALT_OPTIMIZE_HPP
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+namespace cobalt {
+  // name of the metadata on the comparison of a bounds check
+  inline constexpr char bounds_check_md[] = "co.bounds";
+  // remove the bounds checks in f that range analysis proves will pass, locals are promoted to registers first so that their ranges are visible
+  void elide_bounds_checks(llvm::Function& f);
+  // run the initializer init of gv at compile time, which only works if it doesn't call external functions and doesn't write to any other global
+  // on success, the result becomes gv's initializer and init is erased
+  bool fold_global_init(llvm::Function& init, llvm::GlobalVariable& gv);
+}
+#endif
@@ -6,5 +6,8 @@
 namespace cobalt {
   class AST;
   AST parse(span<token> toks, flags_t flags);
+  // reparse after an edit, reusing the nodes of unchanged top-level statements
+  // the tokens of old must still be valid
+  AST reparse(AST&& old, span<token> toks, flags_t flags);
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,10 @@
+#ifndef COBALT_SEMA_HPP
+#define COBALT_SEMA_HPP
+#include "cobalt/ast/ast.hpp"
+namespace cobalt {
+  // resolve names and annotate each node with its type in a single pass, type() then returns the annotation
+  // symbols visible from ctx.vars are used for lookups, but the context isn't modified, ctx.locals is ignored
+  // unparsed function bodies are skipped and typed on demand during codegen
+  void annotate(AST const& ast, base_context& ctx);
+}
+#endif
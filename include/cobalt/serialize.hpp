@@ -0,0 +1,12 @@
+#ifndef COBALT_SERIALIZE_HPP
+#define COBALT_SERIALIZE_HPP
+#include "cobalt/ast/ast.hpp"
+namespace cobalt {
+  // binary AST format, used for .coast files
+  constexpr std::string_view coast_magic = "CoAST";
+  constexpr uint8_t coast_version = 3;
+  void serialize(AST const& ast, llvm::raw_ostream& os);
+  AST deserialize(std::string_view data, flags_t flags = default_flags);
+  AST load_ast(std::string_view path, flags_t flags = default_flags);
+}
+#endif
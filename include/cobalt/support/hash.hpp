@@ -0,0 +1,7 @@
+#ifndef COBALT_SUPPORT_HASH_HPP
+#define COBALT_SUPPORT_HASH_HPP
+#include <cstddef>
+namespace cobalt {
+  constexpr std::size_t hash_combine(std::size_t seed, std::size_t val) noexcept {return seed ^ (val + 0x9e3779b9 + (seed << 6) + (seed >> 2));}
+}
+#endif
@@ -0,0 +1,36 @@
+#ifndef COBALT_SUPPORT_INTERNER_HPP
+#define COBALT_SUPPORT_INTERNER_HPP
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+namespace cobalt {
+  // concurrent map from keys to unique instances, split into shards that each have their own lock
+  // lookups only take a shared lock on one shard, so they only contend with insertions that land in the same shard
+  // Hash and Eq can be transparent, in which case get() can be called with a key view that's only converted to K on insertion
+  template <class K, class T, class Hash = std::hash<K>, class Eq = std::equal_to<K>, unsigned ShardBits = 4> class interner {
+    struct shard {
+      std::shared_mutex mutex;
+      std::unordered_map<K, std::unique_ptr<T>, Hash, Eq> instances;
+    };
+    shard shards[1 << ShardBits];
+    // pointer keys are aligned, so the low bits of their hashes can't be used to pick a shard
+    static std::size_t shard_of(std::size_t hash) noexcept {return (std::uint64_t)hash * 0x9e3779b97f4a7c15ull >> (64 - ShardBits);}
+  public:
+    // make is only called if there isn't an instance yet, and should return a std::unique_ptr<T>
+    template <class L, class F> T const* get(L const& key, F&& make) {
+      auto& s = shards[shard_of(Hash{}(key))];
+      {
+        std::shared_lock lock(s.mutex);
+        auto it = s.instances.find(key);
+        if (it != s.instances.end()) return it->second.get();
+      }
+      std::unique_lock lock(s.mutex);
+      auto it = s.instances.find(key);
+      if (it == s.instances.end()) it = s.instances.emplace(K(key), std::forward<F>(make)()).first;
+      return it->second.get();
+    }
+  };
+}
+#endif
@@ -0,0 +1,32 @@
+#ifndef COBALT_SUPPORT_OPERATORS_HPP
+#define COBALT_SUPPORT_OPERATORS_HPP
+#include <array>
+#include <cstdint>
+#include <string_view>
+namespace cobalt {
+  // operators are interned to these when parsing, and are named by their spelling since most are both unary and binary
+  // postfix operators are spelled with a leading p
+  enum op_t : uint8_t {
+    OP_INVALID,
+    OP_PLUS, OP_MINUS, OP_STAR, OP_SLASH, OP_PERCENT, OP_POW, OP_AMP, OP_PIPE, OP_CARET, OP_SHL, OP_SHR,
+    OP_ASSIGN, OP_PLUS_ASSIGN, OP_MINUS_ASSIGN, OP_STAR_ASSIGN, OP_SLASH_ASSIGN, OP_PERCENT_ASSIGN, OP_POW_ASSIGN, OP_AMP_ASSIGN, OP_PIPE_ASSIGN, OP_CARET_ASSIGN, OP_SHL_ASSIGN, OP_SHR_ASSIGN,
+    OP_LAND, OP_LOR, OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE,
+    OP_BANG, OP_TILDE, OP_INC, OP_DEC, OP_POST_QUESTION, OP_POST_BANG,
+    OP_SEMI
+  };
+  constexpr std::array<std::string_view, OP_SEMI + 1> op_names = {
+    "<invalid>",
+    "+", "-", "*", "/", "%", "^^", "&", "|", "^", "<<", ">>",
+    "=", "+=", "-=", "*=", "/=", "%=", "^^=", "&=", "|=", "^=", "<<=", ">>=",
+    "&&", "||", "==", "!=", "<", "<=", ">", ">=",
+    "!", "~", "++", "--", "p?", "p!",
+    ";"
+  };
+  constexpr std::string_view op_name(op_t op) noexcept {return op_names[op];}
+  constexpr op_t op_id(std::string_view str) noexcept {
+    for (std::size_t i = 1; i < op_names.size(); ++i) if (op_names[i] == str) return op_t(i);
+    return OP_INVALID;
+  }
+  constexpr bool is_postfix(op_t op) noexcept {return op == OP_POST_QUESTION || op == OP_POST_BANG;}
+}
+#endif
@@ -0,0 +1,42 @@
+#ifndef COBALT_SUPPORT_QPATH_HPP
+#define COBALT_SUPPORT_QPATH_HPP
+#include "cobalt/support/sstring.hpp"
+#include <unordered_map>
+#include <vector>
+namespace cobalt {
+  // a dotted name split into its segments, interned so that the address can be used as an ID for the path
+  struct qpath {
+    sstring name;
+    std::vector<sstring> segments;
+    bool absolute; // starts with a dot, so lookups start at the root module
+    // length of the first n segments in name, including the leading dot
+    std::size_t prefix_size(std::size_t n) const noexcept {
+      std::size_t out = absolute + (n ? n - 1 : 0);
+      for (std::size_t i = 0; i < n; ++i) out += segments[i].size();
+      return out;
+    }
+    static qpath const* get(sstring name) {
+      {
+        std::shared_lock lock(mutex);
+        auto it = paths.find(name);
+        if (it != paths.end()) return it->second.get();
+      }
+      auto path = std::make_unique<qpath>(name);
+      std::unique_lock lock(mutex);
+      return paths.try_emplace(name, std::move(path)).first->second.get();
+    }
+    explicit qpath(sstring name) : name(name), absolute(name.starts_with('.')) {
+      std::string_view rest = name;
+      if (absolute) rest.remove_prefix(1);
+      for (auto idx = rest.find('.'); idx != std::string_view::npos; idx = rest.find('.')) {
+        segments.push_back(sstring::get(rest.substr(0, idx)));
+        rest.remove_prefix(idx + 1);
+      }
+      segments.push_back(sstring::get(rest));
+    }
+  private:
+    inline static std::unordered_map<sstring, std::unique_ptr<qpath>> paths;
+    inline static std::shared_mutex mutex;
+  };
+}
+#endif
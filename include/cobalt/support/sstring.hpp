@@ -2,6 +2,8 @@
 #define COBALT_SUPPORT_SSTRING_HPP
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
 #include <unordered_set>
@@ -34,16 +36,29 @@ namespace cobalt {
       enum {value = sizeof(decltype(test<K>(0))) > 1};
     };
     inline static set_t strings;
+    inline static std::shared_mutex mutex;
   public:
     using string [[deprecated("use cobalt::sstring instead of cobalt::sstring::string")]] = sstring;
     template <class K> static sstring get(K&& val) {
       if constexpr(heterogenous_lookup<set_t, decltype((std::forward<K>(val)))>::value) {
-        auto it = strings.find(std::forward<K>(val));
+        {
+          std::shared_lock lock(mutex);
+          auto it = strings.find(val);
+          if (it != strings.end()) return sstring(std::string_view{**it});
+        }
+        std::unique_lock lock(mutex);
+        auto it = strings.find(val);
         if (it == strings.end()) it = strings.insert(ptr_t(new std::string(std::forward<K>(val)), true)).first;
         return sstring(std::string_view{**it});
       }
       else {
         std::string str(std::forward<K>(val));
+        {
+          std::shared_lock lock(mutex);
+          auto it = strings.find(ptr_t(&str, false));
+          if (it != strings.end()) return sstring(std::string_view{**it});
+        }
+        std::unique_lock lock(mutex);
         auto it = strings.find(ptr_t(&str, false));
         if (it == strings.end()) it = strings.insert(ptr_t(new std::string(std::move(str)), true)).first;
         return sstring(std::string_view{**it});
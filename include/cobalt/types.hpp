@@ -1,9 +1,11 @@
 #ifndef COBALT_TYPES_HPP
 #define COBALT_TYPES_HPP
 #include "cobalt/types/types.hpp"
+#include "cobalt/types/arrays.hpp"
 #include "cobalt/types/functions.hpp"
 #include "cobalt/types/null.hpp"
 #include "cobalt/types/numeric.hpp"
 #include "cobalt/types/pointers.hpp"
 #include "cobalt/types/structurals.hpp"
+#include "cobalt/types/vector.hpp"
 #endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef COBALT_TYPES_ARRAYS_HPP
+#define COBALT_TYPES_ARRAYS_HPP
+#include "types.hpp"
+#include "numeric.hpp"
+#include "pointers.hpp"
+#include "cobalt/support/interner.hpp"
+#include <llvm/ADT/Twine.h>
+#include <llvm/IR/DerivedTypes.h>
+namespace cobalt::types {
+  // a fixed number of elements stored inline, T[N]
+  struct array : type_base {
+    type_ptr elem;
+    std::uint64_t count;
+    std::size_t size() const override {return elem->size() * count;}
+    std::size_t align() const override {return elem->align();}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {return llvm::ArrayType::get(elem->llvm_type(loc, ctx), count);}
+    static array const* get(type_ptr elem, std::uint64_t count) {return instances.get(std::pair{elem, count}, [=] {return COBALT_MAKE_UNIQUE(array, elem, count);});}
+  private:
+    array(type_ptr elem, std::uint64_t count) : type_base(ARRAY, sstring::get((llvm::Twine(elem->name()) + "[" + llvm::Twine(count) + "]").str()), hash_combine(hash_combine(ARRAY, elem->hash()), count)), elem(elem), count(count) {}
+    struct array_hash {
+      std::size_t operator()(std::pair<type_ptr, std::uint64_t> const& val) const noexcept {return hash_combine(val.first->hash(), val.second);}
+    };
+    inline static interner<std::pair<type_ptr, std::uint64_t>, array, array_hash> instances;
+  };
+  // a pointer to some elements and how many there are, T[]
+  struct slice : type_base {
+    type_ptr elem;
+    std::size_t size() const override {return 16;} // TODO: support 32-bit platforms
+    std::size_t align() const override {return 8;}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {return llvm::StructType::get(*ctx.context, {llvm::PointerType::get(elem->llvm_type(loc, ctx), 0), llvm::Type::getInt64Ty(*ctx.context)});}
+    static slice const* get(type_ptr elem) {return instances.get(elem, [elem] {return COBALT_MAKE_UNIQUE(slice, elem);});}
+  private:
+    slice(type_ptr elem) : type_base(SLICE, sstring::get(elem->name() + "[]"), hash_combine(elem->hash(), '[')), elem(elem) {}
+    inline static interner<type_ptr, slice> instances;
+  };
+  // the type of the len or ptr field of an array or slice, or a reference to it, or null if there isn't one
+  inline type_ptr sequence_field(type_ptr t, sstring name) {
+    if (t->kind == type_base::REFERENCE) t = static_cast<reference const*>(t)->base;
+    if (t->kind != type_base::ARRAY && t->kind != type_base::SLICE) return nullptr;
+    if (name == "len") return integer::get(64);
+    if (name == "ptr" && t->kind == type_base::SLICE) return pointer::get(static_cast<slice const*>(t)->elem);
+    return nullptr;
+  }
+}
+#endif
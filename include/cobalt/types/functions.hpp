@@ -1,25 +1,66 @@
 #ifndef COBALT_TYPES_FUNCTIONS_HPP
 #define COBALT_TYPES_FUNCTIONS_HPP
+#include "types.hpp"
+#include "cobalt/support/hash.hpp"
+#include "cobalt/support/interner.hpp"
+#include "cobalt/support/span.hpp"
+#include <llvm/ADT/Twine.h>
+namespace cobalt::ast {struct fndef_ast;}
 namespace cobalt::types {
   namespace {
+    // instances are keyed by the return type followed by the arguments, lookups use a view of the caller's arguments instead
+    struct fn_view {
+      type_ptr ret;
+      span<type_ptr const> args;
+      explicit operator std::vector<type_ptr>() const {
+        std::vector<type_ptr> out;
+        out.reserve(args.size() + 1);
+        out.push_back(ret);
+        out.insert(out.end(), args.begin(), args.end());
+        return out;
+      }
+    };
     struct fn_hash {
+      using is_transparent = void;
       std::size_t operator()(std::vector<type_ptr> const& val) const {
         std::size_t out = 0;
-        for (type_ptr ptr : val) out ^= (uintptr_t)ptr + 0x9e3779b9 + (out << 6) + (out >> 2);
+        for (type_ptr ptr : val) out = hash_combine(out, (uintptr_t)ptr);
+        return out;
+      }
+      std::size_t operator()(fn_view const& val) const {
+        std::size_t out = hash_combine(0, (uintptr_t)val.ret);
+        for (type_ptr ptr : val.args) out = hash_combine(out, (uintptr_t)ptr);
         return out;
       }
     };
     struct fn_eq {
+      using is_transparent = void;
       bool operator()(std::vector<type_ptr> const& lhs, std::vector<type_ptr> const& rhs) const {
         if (lhs.size() != rhs.size()) return false;
         return !std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(void*));
       }
+      bool operator()(fn_view const& lhs, std::vector<type_ptr> const& rhs) const {
+        if (lhs.args.size() + 1 != rhs.size() || lhs.ret != rhs.front()) return false;
+        return !std::memcmp(lhs.args.data(), rhs.data() + 1, lhs.args.size() * sizeof(void*));
+      }
+      bool operator()(std::vector<type_ptr> const& lhs, fn_view const& rhs) const {return (*this)(rhs, lhs);}
     };
   }
   struct function : type_base {
     type_ptr ret;
     std::vector<type_ptr> args;
-    sstring name() const override {
+    std::size_t size() const override {return 0;}
+    std::size_t align() const override {return 1;}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {
+      auto r = ret->llvm_type(loc, ctx);
+      std::vector<llvm::Type*> as(args.size());
+      for (std::size_t i = 0; i < args.size(); ++i) as[i] = args[i]->llvm_type(loc, ctx);
+      return llvm::FunctionType::get(r, as, false);
+    }
+    static function const* get(type_ptr ret, std::vector<type_ptr>&& args) {return instances.get(fn_view{ret, args}, [&] {return COBALT_MAKE_UNIQUE(function, ret, std::move(args));});}
+  private:
+    function(type_ptr ret, std::vector<type_ptr>&& args) : type_base(FUNCTION, make_name(ret, args), make_hash(ret, args)), ret(ret), CO_INIT(args) {}
+    static sstring make_name(type_ptr ret, std::vector<type_ptr> const& args) {
       std::string out{ret->name()};
       out += '(';
       for (auto arg : args) {
@@ -33,25 +74,24 @@ namespace cobalt::types {
       }
       return sstring::get(out);
     }
+    static std::size_t make_hash(type_ptr ret, std::vector<type_ptr> const& args) {
+      std::size_t out = hash_combine(FUNCTION, ret->hash());
+      for (auto arg : args) out = hash_combine(out, arg->hash());
+      return out;
+    }
+    inline static interner<std::vector<type_ptr>, function, fn_hash, fn_eq> instances;
+  };
+  // a generic function isn't a value by itself, each list of type arguments it's used with instantiates a separate function
+  struct generic : type_base {
+    ast::fndef_ast const* def;
     std::size_t size() const override {return 0;}
     std::size_t align() const override {return 1;}
-    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {
-      auto r = ret->llvm_type(loc, ctx);
-      std::vector<llvm::Type*> as(args.size());
-      for (std::size_t i = 0; i < args.size(); ++i) as[i] = args[i]->llvm_type(loc, ctx);
-      return llvm::FunctionType::get(r, as, false);
-    }
-    static function const* get(type_ptr ret, std::vector<type_ptr>&& args) {
-      std::vector<type_ptr> lookup(args.size() + 1);
-      lookup[0] = ret;
-      std::memcpy(lookup.data() + 1, args.data(), args.size() * sizeof(type_ptr));
-      auto it = instances.find(lookup);
-      if (it == instances.end()) it = instances.insert({std::move(lookup), COBALT_MAKE_UNIQUE(function, ret, std::move(args))}).first;
-      return it->second.get();
-    }
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {return llvm::Type::getVoidTy(*ctx.context);}
+    static generic const* of(type_ptr t) {return t && t->kind == CUSTOM ? dynamic_cast<generic const*>(t) : nullptr;}
+    static generic const* get(ast::fndef_ast const* def, sstring name) {return instances.get(def, [=] {return COBALT_MAKE_UNIQUE(generic, def, name);});}
   private:
-    function(type_ptr ret, std::vector<type_ptr>&& args) : type_base(FUNCTION), ret(ret), CO_INIT(args) {}
-    inline static std::unordered_map<std::vector<type_ptr>, std::unique_ptr<function>, fn_hash, fn_eq> instances;
+    generic(ast::fndef_ast const* def, sstring name) : type_base(CUSTOM, sstring::get((llvm::Twine("<generic ") + name + ">").str()), hash_combine(hash_combine(CUSTOM, 'g'), std::hash<std::string_view>{}(name))), def(def) {}
+    inline static interner<ast::fndef_ast const*, generic> instances;
   };
 }
 #endif
\ No newline at end of file
@@ -2,74 +2,74 @@
 #define COBALT_TYPES_NUMERIC_HPP
 #include "types.hpp"
 #include "cobalt/context.hpp"
+#include "cobalt/support/interner.hpp"
 #include <llvm/ADT/Twine.h>
+#include <atomic>
 namespace cobalt::types {
   using cobalt::compile_context;
   struct integer : type_base {
     int nbits;
-    sstring name() const override {return sstring::get((nbits < 0 ? llvm::Twine("u") + llvm::Twine(-nbits) : llvm::Twine("i") + llvm::Twine(nbits)).str());}
-    std::size_t size() const override {return (nbits + 7) / 8;}
+    // unsigned widths are stored negated, and odd widths take up as much space as LLVM's storage for them
+    std::size_t size() const override {return ((bits() + 7) / 8 + align() - 1) / align() * align();}
     std::size_t align() const override {
-      if (nbits <= 8) return 1;
-      if (nbits <= 16) return 2;
-      if (nbits <= 32) return 4;
+      auto b = bits();
+      if (b <= 8) return 1;
+      if (b <= 16) return 2;
+      if (b <= 32) return 4;
       return 8;
     }
-    llvm::Type* llvm_type(location, compile_context& ctx) const override {return llvm::Type::getIntNTy(*ctx.context, nbits < 0 ? -nbits : nbits);}
+    unsigned bits() const {return nbits < 0 ? -nbits : nbits;}
+    llvm::Type* llvm_type(location, compile_context& ctx) const override {return llvm::Type::getIntNTy(*ctx.context, bits());}
     static integer const* get(unsigned bits, bool is_unsigned = false) {
       int val = is_unsigned ? -(int)bits : (int)bits;
-      auto it = instances.find(val);
-      if (it == instances.end()) it = instances.insert({val, COBALT_MAKE_UNIQUE(integer, val)}).first;
-      return it->second.get();
+      if (bits >= std::size(small[0])) return instances.get(val, [val] {return COBALT_MAKE_UNIQUE(integer, val);});
+      auto& slot = small[is_unsigned][bits];
+      if (auto ptr = slot.load(std::memory_order_acquire)) return ptr;
+      auto ptr = instances.get(val, [val] {return COBALT_MAKE_UNIQUE(integer, val);});
+      slot.store(ptr, std::memory_order_release);
+      return ptr;
     }
     static integer const* word(llvm::DataLayout const& layout) {return get(layout.getPointerSize() * 8, false);}
     static integer const* uword(llvm::DataLayout const& layout) {return get(layout.getPointerSize() * 8, true);}
   private:
-    integer(int nbits) : type_base(INTEGER), nbits(nbits) {}
-    inline static std::unordered_map<int, std::unique_ptr<integer>> instances;
+    integer(int nbits) : type_base(INTEGER, sstring::get((nbits < 0 ? llvm::Twine("u") + llvm::Twine(-nbits) : llvm::Twine("i") + llvm::Twine(nbits)).str()), hash_combine(INTEGER, nbits)), nbits(nbits) {}
+    inline static interner<int, integer> instances;
+    inline static std::atomic<integer const*> small[2][129]; // widths up to 128 bits skip the interner once they've been created
   };
   struct float16 : type_base {
-    sstring name() const override {return name_;}
     std::size_t size() const override {return 2;}
     std::size_t align() const override {return 2;}
     llvm::Type* llvm_type(location, compile_context& ctx) const override {return llvm::Type::getHalfTy(*ctx.context);}
     static float16 const* get() {return &inst;}
   private:
-    float16() : type_base(FLOAT) {}
-    const inline static sstring name_ = sstring::get("f16");
+    float16() : type_base(FLOAT, sstring::get("f16"), hash_combine(FLOAT, 16)) {}
     const static float16 inst;
   };
   struct float32 : type_base {
-    sstring name() const override {return name_;}
     std::size_t size() const override {return 4;}
     std::size_t align() const override {return 4;}
     llvm::Type* llvm_type(location, compile_context& ctx) const override {return llvm::Type::getFloatTy(*ctx.context);}
     static float32 const* get() {return &inst;}
   private:
-    float32() : type_base(FLOAT) {}
-    const inline static sstring name_ = sstring::get("f32");
+    float32() : type_base(FLOAT, sstring::get("f32"), hash_combine(FLOAT, 32)) {}
     const static float32 inst;
   };
   struct float64 : type_base {
-    sstring name() const override {return name_;}
     std::size_t size() const override {return 8;}
     std::size_t align() const override {return 8;}
     llvm::Type* llvm_type(location, compile_context& ctx) const override {return llvm::Type::getDoubleTy(*ctx.context);}
     static float64 const* get() {return &inst;}
   private:
-    float64() : type_base(FLOAT) {}
-    const inline static sstring name_ = sstring::get("f64");
+    float64() : type_base(FLOAT, sstring::get("f64"), hash_combine(FLOAT, 64)) {}
     const static float64 inst;
   };
   struct float128 : type_base {
-    sstring name() const override {return name_;}
     std::size_t size() const override {return 16;}
     std::size_t align() const override {return 8;}
     llvm::Type* llvm_type(location, compile_context& ctx) const override {return llvm::Type::getFP128Ty(*ctx.context);}
     static float128 const* get() {return &inst;}
   private:
-    float128() : type_base(FLOAT) {}
-    const inline static sstring name_ = sstring::get("f128");
+    float128() : type_base(FLOAT, sstring::get("f128"), hash_combine(FLOAT, 128)) {}
     const static float128 inst;
   };
   const inline float16 float16::inst;
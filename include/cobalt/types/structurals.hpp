@@ -1,6 +1,11 @@
 #ifndef COBALT_TYPES_STRUCTURALS_HPP
 #define COBALT_TYPES_STRUCTURALS_HPP
 #include "types.hpp"
+#include "numeric.hpp"
+#include "null.hpp"
+#include "cobalt/support/interner.hpp"
+#include <llvm/IR/DerivedTypes.h>
+#include <algorithm>
 namespace cobalt::types {
   namespace {
     struct tuple_hash {
@@ -24,45 +29,477 @@ namespace cobalt::types {
       }
     };
   }
+  // smallest number of bytes that can hold a discriminant for count alternatives, 0 if there's only one
+  inline std::size_t tag_size(std::size_t count) {
+    if (count <= 1) return 0;
+    if (count <= 0x100) return 1;
+    if (count <= 0x10000) return 2;
+    if (count <= 0x100000000ull) return 4;
+    return 8;
+  }
+  // opaque storage, as an array of integers as wide as its alignment so that LLVM aligns it the same way
+  inline llvm::Type* storage_type(std::size_t size, std::size_t align, llvm::LLVMContext& ctx) {return llvm::ArrayType::get(llvm::Type::getIntNTy(ctx, align * 8), (size + align - 1) / align);}
   struct tuple : type_base {
     std::vector<type_ptr> types;
-    sstring name() const override;
-    std::size_t size() const override;
-    std::size_t align() const override;
-    llvm::Type* llvm_type(location loc, compile_context& ctx) const override;
-    static tuple const* get(std::vector<type_ptr> const& types) {
-      auto it = instances.find(types);
-      if (it == instances.end()) it = instances.insert({types, COBALT_MAKE_UNIQUE(tuple, types)}).first;
-      return it->second.get();
+    std::vector<std::size_t> offsets; // in bytes, for each element
+    std::vector<unsigned> indices; // element index in the LLVM type, for each element
+    std::size_t size() const override {return size_;}
+    std::size_t align() const override {return align_;}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {
+      std::vector<llvm::Type*> elems(types.size());
+      for (std::size_t i = 0; i < types.size(); ++i) elems[indices[i]] = types[i]->llvm_type(loc, ctx);
+      return llvm::StructType::get(*ctx.context, elems);
     }
+    static tuple const* get(std::vector<type_ptr> const& types) {return instances.get(types, [&] {return COBALT_MAKE_UNIQUE(tuple, types);});}
   private:
-    tuple(std::vector<type_ptr> const& types) : type_base(CUSTOM), types(types) {}
-    inline static std::unordered_map<std::vector<type_ptr>, std::unique_ptr<tuple>, tuple_hash, tuple_eq> instances;
+    std::size_t size_ = 0, align_ = 1;
+    tuple(std::vector<type_ptr> const& types) : type_base(CUSTOM, make_name(types), make_hash(types)), types(types), offsets(types.size()), indices(types.size()) {
+      std::vector<unsigned> order(types.size());
+      for (unsigned i = 0; i < order.size(); ++i) order[i] = i;
+      // laid out like an efficient struct, the most-aligned elements go first
+      std::stable_sort(order.begin(), order.end(), [&types] (unsigned l, unsigned r) {return types[l]->align() > types[r]->align();});
+      for (unsigned i = 0; i < order.size(); ++i) {
+        auto t = types[order[i]];
+        auto a = t->align();
+        size_ = (size_ + a - 1) / a * a;
+        offsets[order[i]] = size_;
+        indices[order[i]] = i;
+        size_ += t->size();
+        if (a > align_) align_ = a;
+      }
+      size_ = (size_ + align_ - 1) / align_ * align_;
+    }
+    static sstring make_name(std::vector<type_ptr> const& types) {
+      std::string out = "(";
+      for (auto t : types) {
+        out += t->name();
+        out += ", ";
+      }
+      if (types.empty()) out += ")";
+      else {
+        out.pop_back();
+        out.back() = ')';
+      }
+      return sstring::get(out);
+    }
+    static std::size_t make_hash(std::vector<type_ptr> const& types) {
+      std::size_t out = hash_combine(CUSTOM, '(');
+      for (auto t : types) out = hash_combine(out, t->hash());
+      return out;
+    }
+    inline static interner<std::vector<type_ptr>, tuple, tuple_hash, tuple_eq> instances;
   };
+  struct tag_enum;
+  // a tagged union, the tag is stored in invalid values of the payload when the other alternatives are empty
+  // optionals, T?, are variants of T and null
   struct variant : type_base {
+    enum repr_t {
+      EMPTY, // no alternatives
+      SINGLE, // one alternative, stored as itself
+      NICHE, // one alternative with a size, the others are stored as values it can't have
+      TAGGED // the payload, followed by the smallest tag that fits, as one integer if the payloads are all integers and it fits in 64 bits
+    };
     std::unordered_set<type_ptr> types;
-    sstring name() const override;
-    std::size_t size() const override;
-    std::size_t align() const override;
-    llvm::Type* llvm_type(location loc, compile_context& ctx) const override;
-    static variant const* get(std::unordered_set<type_ptr> const& types) {
-      auto it = instances.find(types);
-      if (it == instances.end()) it = instances.insert({types, COBALT_MAKE_UNIQUE(variant, types)}).first;
-      return it->second.get();
+    std::vector<type_ptr> alts; // sorted by name, with null last, the tag of an alternative is its index in this
+    repr_t repr = EMPTY;
+    type_ptr dataful = nullptr; // for NICHE, the only alternative with a size
+    std::uint64_t niche_start = 0; // for NICHE, the first invalid value of dataful, integers are zero-extended to their storage size
+    std::size_t size() const override {return size_;}
+    std::size_t align() const override {return align_;}
+    std::size_t tag_offset() const {return tag_offset_;} // for TAGGED
+    bool packed() const {return packed_;} // for TAGGED, if it's stored as an integer
+    // if this is an optional, the type of its value
+    type_ptr optional_of() const {return alts.size() == 2 && alts.back()->kind == NULLTYPE ? alts.front() : nullptr;}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {
+      switch (repr) {
+        case EMPTY: return llvm::StructType::get(*ctx.context);
+        case SINGLE: return alts.front()->llvm_type(loc, ctx);
+        case NICHE: return dataful->kind == INTEGER ? llvm::Type::getIntNTy(*ctx.context, dataful->size() * 8) : dataful->llvm_type(loc, ctx);
+        case TAGGED: {
+          if (packed_) return llvm::Type::getIntNTy(*ctx.context, size_ * 8);
+          auto tag = llvm::Type::getIntNTy(*ctx.context, tag_size(alts.size()) * 8);
+          if (!tag_offset_) return llvm::StructType::get(*ctx.context, llvm::ArrayRef<llvm::Type*>{tag});
+          return llvm::StructType::get(*ctx.context, {storage_type(tag_offset_, payload_align, *ctx.context), tag});
+        }
+      }
+      return nullptr; // unreachable
+    }
+    int index_of(type_ptr t) const {
+      auto it = std::find(alts.begin(), alts.end(), t);
+      return it == alts.end() ? -1 : it - alts.begin();
+    }
+    // a variant holding v, which has type t, v is ignored if t has no size
+    llvm::Value* wrap(llvm::Value* v, type_ptr t, location loc, compile_context& ctx) const {
+      auto vt = llvm_type(loc, ctx);
+      auto idx = index_of(t);
+      switch (repr) {
+        case EMPTY: return llvm::UndefValue::get(vt);
+        case SINGLE: return v;
+        case NICHE:
+          if (t == dataful) return dataful->kind == INTEGER ? ctx.builder.CreateZExt(v, vt) : v;
+          if (dataful->kind == INTEGER || dataful->kind == ENUM) return llvm::ConstantInt::get(vt, niche_start + idx - (idx > index_of(dataful)));
+          return llvm::Constant::getNullValue(vt);
+        case TAGGED: {
+          // on little-endian targets, this has the same layout as the struct form
+          if (packed_) {
+            auto tag = llvm::ConstantInt::get(vt, (std::uint64_t)idx << (tag_offset_ * 8));
+            return t->size() ? ctx.builder.CreateOr(ctx.builder.CreateZExt(v, vt), tag) : tag;
+          }
+          auto tag = llvm::ConstantInt::get(llvm::Type::getIntNTy(*ctx.context, tag_size(alts.size()) * 8), idx);
+          if (!tag_offset_ || !t->size()) return ctx.builder.CreateInsertValue(llvm::UndefValue::get(vt), tag, {tag_offset_ ? 1u : 0u});
+          // the payload's type is opaque, so it's written through memory
+          auto a = temporary(vt, ctx);
+          ctx.builder.CreateStore(v, ctx.builder.CreateBitCast(a, llvm::PointerType::get(t->llvm_type(loc, ctx), 0)));
+          ctx.builder.CreateStore(tag, ctx.builder.CreateStructGEP(vt, a, 1));
+          return ctx.builder.CreateLoad(vt, a);
+        }
+      }
+      return nullptr; // unreachable
+    }
+    // the tag of a variant value, as an i32
+    llvm::Value* get_tag(llvm::Value* v, location loc, compile_context& ctx) const {
+      auto i32 = llvm::Type::getInt32Ty(*ctx.context);
+      switch (repr) {
+        case EMPTY: case SINGLE: return llvm::ConstantInt::get(i32, 0);
+        case NICHE: {
+          unsigned di = index_of(dataful);
+          if (dataful->kind != INTEGER && dataful->kind != ENUM) return ctx.builder.CreateSelect(ctx.builder.CreateIsNull(v), llvm::ConstantInt::get(i32, di ? 0 : 1), llvm::ConstantInt::get(i32, di));
+          // niche values are the other alternatives in order, skipping over dataful's tag
+          auto rel = ctx.builder.CreateSub(v, llvm::ConstantInt::get(v->getType(), niche_start));
+          auto other = ctx.builder.CreateAdd(rel, ctx.builder.CreateZExt(ctx.builder.CreateICmpUGE(rel, llvm::ConstantInt::get(v->getType(), di)), v->getType()));
+          auto tag = ctx.builder.CreateSelect(ctx.builder.CreateICmpULT(rel, llvm::ConstantInt::get(v->getType(), alts.size() - 1)), other, llvm::ConstantInt::get(v->getType(), di));
+          return ctx.builder.CreateZExtOrTrunc(tag, i32);
+        }
+        case TAGGED:
+          if (packed_) return ctx.builder.CreateZExtOrTrunc(ctx.builder.CreateTrunc(ctx.builder.CreateLShr(v, tag_offset_ * 8), llvm::Type::getIntNTy(*ctx.context, tag_size(alts.size()) * 8)), i32);
+          return ctx.builder.CreateZExtOrTrunc(ctx.builder.CreateExtractValue(v, {tag_offset_ ? 1u : 0u}), i32);
+      }
+      return nullptr; // unreachable
+    }
+    // the payload of a variant value that holds a t, or null if t has no size
+    llvm::Value* unwrap(llvm::Value* v, type_ptr t, location loc, compile_context& ctx) const {
+      if (!t->size()) return nullptr;
+      switch (repr) {
+        case EMPTY: return nullptr;
+        case SINGLE: return v;
+        case NICHE: return dataful->kind == INTEGER ? ctx.builder.CreateTrunc(v, t->llvm_type(loc, ctx)) : v;
+        case TAGGED: {
+          if (packed_) return ctx.builder.CreateTrunc(v, t->llvm_type(loc, ctx));
+          auto vt = llvm_type(loc, ctx);
+          auto a = temporary(vt, ctx);
+          ctx.builder.CreateStore(v, a);
+          auto pt = t->llvm_type(loc, ctx);
+          return ctx.builder.CreateLoad(pt, ctx.builder.CreateBitCast(a, llvm::PointerType::get(pt, 0)));
+        }
+      }
+      return nullptr; // unreachable
     }
+    static variant const* get(std::unordered_set<type_ptr> const& types) {return instances.get(types, [&] {return COBALT_MAKE_UNIQUE(variant, types);});}
+    static variant const* optional(type_ptr t) {return get({t, null::get()});}
   private:
-    variant(std::unordered_set<type_ptr> const& types) : type_base(CUSTOM), types(types) {}
-    inline static std::unordered_map<std::unordered_set<type_ptr>, std::unique_ptr<variant>, variant_hash> instances;
+    std::size_t size_ = 0, align_ = 1, tag_offset_ = 0, payload_align = 1;
+    bool packed_ = false;
+    variant(std::unordered_set<type_ptr> const& types) : type_base(VARIANT, make_name(types), make_hash(types)), types(types), alts(types.begin(), types.end()) {
+      // null is last so that an optional's tag is 0 when it has a value
+      std::sort(alts.begin(), alts.end(), [] (type_ptr l, type_ptr r) {
+        if ((l->kind == NULLTYPE) != (r->kind == NULLTYPE)) return r->kind == NULLTYPE;
+        return l->name() == r->name() ? l->hash() < r->hash() : l->name() < r->name();
+      });
+      if (alts.empty()) return;
+      if (alts.size() == 1) {
+        repr = SINGLE;
+        size_ = alts.front()->size();
+        align_ = alts.front()->align();
+        return;
+      }
+      std::size_t sized = 0;
+      for (auto t : alts) if (t->size()) {
+        ++sized;
+        dataful = t;
+        if (t->align() > payload_align) payload_align = t->align();
+        if (t->size() > tag_offset_) tag_offset_ = t->size();
+      }
+      if (sized == 1) {
+        auto [count, start] = niches(dataful);
+        if (count >= alts.size() - 1) {
+          repr = NICHE;
+          niche_start = start;
+          size_ = dataful->size();
+          align_ = dataful->align();
+          return;
+        }
+      }
+      dataful = nullptr;
+      repr = TAGGED;
+      auto ts = tag_size(alts.size());
+      tag_offset_ = (tag_offset_ + payload_align - 1) / payload_align * payload_align;
+      align_ = std::max(payload_align, ts);
+      size_ = (tag_offset_ + ts + align_ - 1) / align_ * align_;
+      packed_ = size_ <= 8 && std::all_of(alts.begin(), alts.end(), [] (type_ptr t) {return !t->size() || t->kind == INTEGER;});
+    }
+    // the number of values a type's storage can hold that aren't valid values of it, and the first of them
+    static std::pair<std::uint64_t, std::uint64_t> niches(type_ptr t) {
+      switch (t->kind) {
+        case POINTER: case REFERENCE: return {1, 0};
+        case INTEGER: {
+          std::uint64_t bits = static_cast<integer const*>(t)->bits(), storage = t->size() * 8;
+          if (bits >= storage || storage > 64) return {0, 0};
+          return {(~0ull >> (64 - storage)) - (1ull << bits) + 1, 1ull << bits};
+        }
+        case ENUM: return niches_of_enum(t);
+        default: return {0, 0};
+      }
+    }
+    static std::pair<std::uint64_t, std::uint64_t> niches_of_enum(type_ptr t);
+    // an alloca in the entry block, so that it can be promoted
+    static llvm::Value* temporary(llvm::Type* t, compile_context& ctx) {
+      auto& entry = ctx.builder.GetInsertBlock()->getParent()->getEntryBlock();
+      return llvm::IRBuilder<>(&entry, entry.begin()).CreateAlloca(t);
+    }
+    // the set has no stable order, so the names are sorted and the hashes are summed
+    static sstring make_name(std::unordered_set<type_ptr> const& types) {
+      if (types.size() == 2 && types.contains(null::get())) for (auto t : types) if (t->kind != NULLTYPE) return sstring::get(t->name() + "?");
+      std::vector<std::string_view> names;
+      for (auto t : types) names.push_back(t->name());
+      std::sort(names.begin(), names.end());
+      std::string out = "(";
+      for (auto n : names) {
+        out += n;
+        out += " | ";
+      }
+      if (!names.empty()) out.resize(out.size() - 3);
+      out += ')';
+      return sstring::get(out);
+    }
+    static std::size_t make_hash(std::unordered_set<type_ptr> const& types) {
+      std::size_t out = 0;
+      for (auto t : types) out += t->hash();
+      return hash_combine(hash_combine(VARIANT, '|'), out);
+    }
+    inline static interner<std::unordered_set<type_ptr>, variant, variant_hash> instances;
   };
+  // structs are identified by their qualified name, fields, and layout, so defining the same struct twice gives the same type
   struct struct_ : type_base {
-    enum layout_t {C, EFFICIENT, PACKED};
+    enum layout_t {C, EFFICIENT, PACKED}; // C keeps declaration order, EFFICIENT reorders to minimize padding, PACKED has no padding
+    enum heat_t {NORMAL, HOT, COLD}; // HOT fields go first, on a cache line boundary, COLD fields are moved to a separate allocation
+    constexpr static std::size_t cache_line = 64;
+    struct field_spec {
+      sstring name;
+      type_ptr type;
+      heat_t heat = NORMAL;
+      bool operator==(field_spec const& other) const = default;
+    };
+    struct field {
+      sstring name;
+      type_ptr type;
+      heat_t heat = NORMAL;
+      std::size_t offset = 0; // from the start of the struct, or of the cold part for cold fields, in bytes
+      unsigned index = 0; // element index in the LLVM type, or in the cold part's type for cold fields
+    };
     layout_t layout;
+    std::vector<field> fields; // in declaration order
+    // the out-of-line part, pointed to by the last element, if there are cold fields
+    // every copy of a struct gets its own cold part, which is freed along with it
+    struct_ const* cold = nullptr;
+    std::size_t size() const override {return size_;}
+    std::size_t align() const override {return align_;}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {
+      std::vector<llvm::Type*> elems(cold ? fields.size() - cold->fields.size() + 1 : fields.size());
+      for (auto const& f : fields) if (f.heat != COLD) elems[f.index] = f.type->llvm_type(loc, ctx);
+      if (cold) elems[cold_index_] = llvm::PointerType::get(cold->llvm_type(loc, ctx), 0);
+      return llvm::StructType::get(*ctx.context, elems, layout == PACKED);
+    }
+    unsigned cold_index() const {return cold_index_;} // element index of the pointer to the cold part
+    field const* get_field(sstring name) const {
+      for (auto const& f : fields) if (f.name == name) return &f;
+      return nullptr;
+    }
+    // the type of a field of t, fields of references to structs are references too
+    static type_ptr field_type(type_ptr t, sstring name) {
+      bool is_ref = t->kind == REFERENCE;
+      if (is_ref) t = static_cast<reference const*>(t)->base;
+      if (t->kind != STRUCT) return nullptr;
+      auto f = static_cast<struct_ const*>(t)->get_field(name);
+      return f ? is_ref ? reference::get(f->type) : f->type : nullptr;
+    }
+    static struct_ const* get(sstring name, std::vector<field_spec> const& fields, layout_t layout = EFFICIENT) {
+      // the cold part is interned first, since the shard is locked while this one is made
+      struct_ const* cold = nullptr;
+      if (std::any_of(fields.begin(), fields.end(), [] (field_spec const& f) {return f.heat == COLD;})) {
+        std::vector<field_spec> cold_fs;
+        for (auto const& f : fields) if (f.heat == COLD) cold_fs.push_back({f.name, f.type});
+        cold = get(sstring::get(std::string(name) + ".cold"), cold_fs, layout);
+      }
+      return instances.get(key_t{name, fields, layout}, [&] {return COBALT_MAKE_UNIQUE(struct_, name, fields, layout, cold);});
+    }
+    static struct_ const* get(sstring name, std::vector<std::pair<sstring, type_ptr>> const& fields, layout_t layout = EFFICIENT) {
+      std::vector<field_spec> fs;
+      fs.reserve(fields.size());
+      for (auto [n, t] : fields) fs.push_back({n, t});
+      return get(name, fs, layout);
+    }
+  private:
+    std::size_t size_ = 0, align_ = 1;
+    unsigned cold_index_ = 0;
+    struct_(sstring name, std::vector<field_spec> const& fs, layout_t layout, struct_ const* cold) : type_base(STRUCT, name, make_hash(name, fs, layout)), layout(layout), cold(cold) {
+      fields.reserve(fs.size());
+      for (auto const& f : fs) fields.push_back({f.name, f.type, f.heat});
+      if (cold) {
+        for (auto& f : fields) if (f.heat == COLD) {
+          auto cf = cold->get_field(f.name);
+          f.offset = cf->offset;
+          f.index = cf->index;
+        }
+      }
+      // the cold pointer is element -1 here, it's sorted like a normal field
+      std::vector<int> order;
+      for (int i = 0; i < (int)fields.size(); ++i) if (fields[i].heat != COLD) order.push_back(i);
+      if (cold) order.push_back(-1);
+      auto align_of = [this] (int i) {return i < 0 ? sizeof(void*) : fields[i].type->align();};
+      auto is_hot = [this] (int i) {return i >= 0 && fields[i].heat == HOT;};
+      std::stable_partition(order.begin(), order.end(), is_hot);
+      // with power-of-two alignments, placing the most-aligned fields first leaves no padding between fields
+      if (layout == EFFICIENT) std::stable_sort(order.begin(), order.end(), [&] (int l, int r) {return is_hot(l) != is_hot(r) ? is_hot(l) : align_of(l) > align_of(r);});
+      for (unsigned i = 0; i < order.size(); ++i) {
+        auto a = layout == PACKED ? 1 : align_of(order[i]);
+        size_ = (size_ + a - 1) / a * a;
+        if (order[i] >= 0) {
+          fields[order[i]].offset = size_;
+          fields[order[i]].index = i;
+          size_ += fields[order[i]].type->size();
+        }
+        else {
+          cold_index_ = i;
+          size_ += sizeof(void*);
+        }
+        if (a > align_) align_ = a;
+      }
+      // hot fields are first, so aligning the whole struct to a cache line puts them at the start of one
+      if (order.size() && is_hot(order.front())) align_ = std::max(align_, cache_line);
+      size_ = (size_ + align_ - 1) / align_ * align_;
+    }
+    static std::size_t make_hash(sstring name, std::vector<field_spec> const& fields, layout_t layout) {
+      std::size_t out = hash_combine(hash_combine(STRUCT, std::hash<std::string_view>{}(name)), layout);
+      for (auto const& f : fields) out = hash_combine(hash_combine(hash_combine(out, std::hash<std::string_view>{}(f.name)), f.type->hash()), f.heat);
+      return out;
+    }
+    struct key_t {
+      sstring name;
+      std::vector<field_spec> fields;
+      layout_t layout;
+      bool operator==(key_t const& other) const = default;
+    };
+    struct key_hash {
+      std::size_t operator()(key_t const& val) const {
+        std::size_t out = hash_combine(std::hash<sstring>{}(val.name), val.layout);
+        for (auto const& f : val.fields) out = hash_combine(hash_combine(hash_combine(out, std::hash<sstring>{}(f.name)), (uintptr_t)f.type), f.heat);
+        return out;
+      }
+    };
+    inline static interner<key_t, struct_, key_hash> instances;
+  };
+  // structure of arrays for a struct type, each field is stored in its own column
+  // the value is a pointer to each column, in declaration order, followed by the number of elements
+  struct soa : type_base {
+    struct_ const* elem;
+    std::size_t size() const override {return (elem->fields.size() + 1) * sizeof(void*);}
+    std::size_t align() const override {return sizeof(void*);}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {
+      std::vector<llvm::Type*> elems;
+      elems.reserve(elem->fields.size() + 1);
+      for (auto const& f : elem->fields) elems.push_back(llvm::PointerType::get(f.type->llvm_type(loc, ctx), 0));
+      elems.push_back(llvm::Type::getInt64Ty(*ctx.context));
+      return llvm::StructType::get(*ctx.context, elems);
+    }
+    // index of a field's column in the LLVM type
+    unsigned column(struct_::field const* f) const {return f - elem->fields.data();}
+    // t if it's a structure of arrays or a reference to one, otherwise null
+    static soa const* of(type_ptr t) {
+      if (t->kind == REFERENCE) t = static_cast<reference const*>(t)->base;
+      return t->kind == SOA ? static_cast<soa const*>(t) : nullptr;
+    }
+    static soa const* get(struct_ const* elem) {return instances.get(elem, [elem] {return COBALT_MAKE_UNIQUE(soa, elem);});}
+  private:
+    soa(struct_ const* elem) : type_base(SOA, sstring::get("soa[" + std::string(elem->name()) + "]"), hash_combine(SOA, elem->hash())), elem(elem) {}
+    inline static interner<struct_ const*, soa> instances;
   };
+  // an untagged union, all of its types are stored at the start
   struct union_ : type_base {
-
+    std::vector<type_ptr> types;
+    std::size_t size() const override {return size_;}
+    std::size_t align() const override {return align_;}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {
+      if (!size_) return llvm::StructType::get(*ctx.context);
+      return llvm::StructType::get(*ctx.context, llvm::ArrayRef<llvm::Type*>{storage_type(size_, align_, *ctx.context)});
+    }
+    static union_ const* get(std::vector<type_ptr> const& types) {return instances.get(types, [&] {return COBALT_MAKE_UNIQUE(union_, types);});}
+  private:
+    std::size_t size_ = 0, align_ = 1;
+    union_(std::vector<type_ptr> const& types) : type_base(CUSTOM, make_name(types), make_hash(types)), types(types) {
+      for (auto t : types) {
+        if (t->size() > size_) size_ = t->size();
+        if (t->align() > align_) align_ = t->align();
+      }
+      size_ = (size_ + align_ - 1) / align_ * align_;
+    }
+    static sstring make_name(std::vector<type_ptr> const& types) {
+      std::string out = "union(";
+      for (auto t : types) {
+        out += t->name();
+        out += ", ";
+      }
+      if (!types.empty()) out.resize(out.size() - 2);
+      out += ')';
+      return sstring::get(out);
+    }
+    static std::size_t make_hash(std::vector<type_ptr> const& types) {
+      std::size_t out = hash_combine(CUSTOM, 'u');
+      for (auto t : types) out = hash_combine(out, t->hash());
+      return out;
+    }
+    inline static interner<std::vector<type_ptr>, union_, tuple_hash, tuple_eq> instances;
   };
+  // a C-style enumeration, each value is stored as its index, in the smallest integer that fits
   struct tag_enum : type_base {
-
+    std::vector<sstring> values;
+    std::size_t size() const override {return tag_size(values.size());}
+    std::size_t align() const override {return std::max<std::size_t>(size(), 1);}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {
+      (void)loc;
+      if (auto sz = size()) return llvm::Type::getIntNTy(*ctx.context, sz * 8);
+      return llvm::StructType::get(*ctx.context);
+    }
+    int index_of(sstring value) const {
+      auto it = std::find(values.begin(), values.end(), value);
+      return it == values.end() ? -1 : it - values.begin();
+    }
+    static tag_enum const* get(sstring name, std::vector<sstring> const& values) {return instances.get(key_t{name, values}, [&] {return COBALT_MAKE_UNIQUE(tag_enum, name, values);});}
+  private:
+    tag_enum(sstring name, std::vector<sstring> const& values) : type_base(ENUM, name, make_hash(name, values)), values(values) {}
+    static std::size_t make_hash(sstring name, std::vector<sstring> const& values) {
+      std::size_t out = hash_combine(ENUM, std::hash<std::string_view>{}(name));
+      for (auto v : values) out = hash_combine(out, std::hash<std::string_view>{}(v));
+      return out;
+    }
+    struct key_t {
+      sstring name;
+      std::vector<sstring> values;
+      bool operator==(key_t const& other) const = default;
+    };
+    struct key_hash {
+      std::size_t operator()(key_t const& val) const {
+        std::size_t out = std::hash<sstring>{}(val.name);
+        for (auto v : val.values) out = hash_combine(out, std::hash<sstring>{}(v));
+        return out;
+      }
+    };
+    inline static interner<key_t, tag_enum, key_hash> instances;
   };
+  // values past the last one are unused
+  inline std::pair<std::uint64_t, std::uint64_t> variant::niches_of_enum(type_ptr t) {
+    auto n = static_cast<tag_enum const*>(t)->values.size(), storage = t->size() * 8;
+    if (!storage) return {0, 0};
+    return {(~0ull >> (64 - storage)) - n + 1, n};
+  }
 }
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 #define COBALT_MAKE_UNIQUE(TYPE, ...) std::unique_ptr<TYPE>(new TYPE(__VA_ARGS__))
 #include "cobalt/context.hpp"
 #include "cobalt/support/sstring.hpp"
+#include "cobalt/support/hash.hpp"
 #include "cobalt/support/location.hpp"
 #include <llvm/IR/Type.h>
 #include <llvm/IR/LLVMContext.h>
@@ -10,16 +11,21 @@ namespace cobalt {
   struct compile_context;
   namespace types {
     struct type_base {
-      enum kind_t {INTEGER, FLOAT, POINTER, REFERENCE, FUNCTION, NULLTYPE, CUSTOM};
+      enum kind_t {INTEGER, FLOAT, POINTER, REFERENCE, FUNCTION, NULLTYPE, VECTOR, ARRAY, SLICE, STRUCT, SOA, VARIANT, ENUM, CUSTOM};
       const kind_t kind;
-      type_base(kind_t kind) : kind(kind) {}
+      // the name and hash are computed once when a type is interned, the hash only depends on the type's structure, so it's stable between runs
+      type_base(kind_t kind, sstring name, std::size_t hash) : kind(kind), name_(name), hash_(hash) {}
       type_base(type_base const&) = delete;
       type_base(type_base&&) = delete;
       virtual ~type_base() = 0;
-      virtual sstring name() const = 0;
+      sstring name() const noexcept {return name_;}
+      std::size_t hash() const noexcept {return hash_;}
       virtual std::size_t size() const = 0;
       virtual std::size_t align() const = 0;
       virtual llvm::Type* llvm_type(location loc, compile_context& ctx) const = 0;
+    private:
+      const sstring name_;
+      const std::size_t hash_;
     };
     inline type_base::~type_base() {}
   }
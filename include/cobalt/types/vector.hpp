@@ -0,0 +1,33 @@
+#ifndef COBALT_TYPES_VECTOR_HPP
+#define COBALT_TYPES_VECTOR_HPP
+#include "types.hpp"
+#include "numeric.hpp"
+#include "pointers.hpp"
+#include "cobalt/support/interner.hpp"
+#include <llvm/ADT/Twine.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <bit>
+namespace cobalt::types {
+  // a fixed-width SIMD vector of integers or floats, like f32x8, operators on it apply to each element
+  struct vector : type_base {
+    type_ptr elem;
+    unsigned count;
+    // LLVM aligns vectors to their size, rounded up to a power of two
+    std::size_t size() const override {return std::bit_ceil(elem->size() * count);}
+    std::size_t align() const override {return size();}
+    llvm::Type* llvm_type(location loc, compile_context& ctx) const override {return llvm::FixedVectorType::get(elem->llvm_type(loc, ctx), count);}
+    // the vector type of a value of type t, or null if it isn't one
+    static vector const* of(type_ptr t) {
+      if (t && t->kind == REFERENCE) t = static_cast<reference const*>(t)->base;
+      return t && t->kind == VECTOR ? static_cast<vector const*>(t) : nullptr;
+    }
+    static vector const* get(type_ptr elem, unsigned count) {return instances.get(std::pair{elem, count}, [=] {return COBALT_MAKE_UNIQUE(vector, elem, count);});}
+  private:
+    vector(type_ptr elem, unsigned count) : type_base(VECTOR, sstring::get((llvm::Twine(elem->name()) + "x" + llvm::Twine(count)).str()), hash_combine(hash_combine(VECTOR, elem->hash()), count)), elem(elem), count(count) {}
+    struct vector_hash {
+      std::size_t operator()(std::pair<type_ptr, unsigned> const& val) const noexcept {return hash_combine(val.first->hash(), val.second);}
+    };
+    inline static interner<std::pair<type_ptr, unsigned>, vector, vector_hash> instances;
+  };
+}
+#endif
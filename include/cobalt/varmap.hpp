@@ -4,6 +4,7 @@
 #include "typed_value.hpp"
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Function.h>
+#include <llvm/ADT/SmallVector.h>
 #include <memory>
 #include <variant>
 namespace cobalt {
@@ -25,30 +26,134 @@ namespace cobalt {
   struct varmap;
   using symbol_type = std::variant<typed_value, types::type_base const*, std::shared_ptr<varmap>>;
   using symbol_ptr = symbol_type const*;
+  inline bool same_symbol(symbol_type const& lhs, symbol_type const& rhs) {
+    if (lhs.index() != rhs.index()) return false;
+    switch (lhs.index()) {
+      case 0: return std::get<0>(lhs).value == std::get<0>(rhs).value && std::get<0>(lhs).type == std::get<0>(rhs).type;
+      case 1: return std::get<1>(lhs) == std::get<1>(rhs);
+      case 2: return std::get<2>(lhs) == std::get<2>(rhs);
+    }
+    return false;
+  }
+  // a point in the history of a tree of modules, which all share the clock of their root
+  // as a cutoff for lookups, only what the tree had at that point is visible, and other trees aren't affected
+  struct scope_stamp {
+    std::size_t const* clock = nullptr;
+    std::size_t gen = -1;
+    bool operator==(scope_stamp const&) const = default;
+  };
   struct varmap {
     varmap* parent;
     std::unordered_map<sstring, symbol_type> symbols;
-    varmap(varmap* parent = nullptr, decltype(symbols)&& symbols = {}) : parent(parent), symbols(std::move(symbols)) {}
-    bool imported(varmap* other) const {return this == other || (parent && parent->imported(other));}
-    symbol_ptr get(sstring name) const {
+    std::unordered_map<sstring, std::size_t> added; // clock value when each symbol was added, symbols passed to the constructor don't have one
+    std::vector<std::pair<std::shared_ptr<varmap>, std::size_t>> imports; // glob imports and the clock value they were made at, these are searched after symbols instead of being copied into it
+    std::size_t generation = 0; // bumped whenever any module in this tree gains a symbol, only the root's is used
+    std::size_t* clock; // the root's generation
+    varmap(varmap* parent = nullptr, decltype(symbols)&& symbols = {}) : parent(parent), symbols(std::move(symbols)), clock(parent ? parent->clock : &generation) {}
+    varmap(varmap const&) = delete;
+    varmap& operator=(varmap const&) = delete;
+    scope_stamp now() const noexcept {return {clock, *clock};}
+    // this module and its glob imports, without the parents
+    symbol_ptr get_here(sstring name, scope_stamp cut = {}) const {
       auto it = symbols.find(name);
-      return it == symbols.end() ? (parent ? parent->get(name) : nullptr) : &it->second;
+      if (it != symbols.end() && shown(name, cut)) return &it->second;
+      if (imports.empty()) return nullptr;
+      llvm::SmallVector<varmap const*, 8> seen = {this};
+      return get_imported(name, seen, cut);
     }
-    bool insert(sstring name, symbol_type sym) {return symbols.insert(std::pair{name, sym}).second;}
-    std::unordered_set<sstring> include(varmap* other) {
+    symbol_ptr get(sstring name, scope_stamp cut = {}) const {
+      if (auto ptr = get_here(name, cut)) return ptr;
+      return parent ? parent->get(name, cut) : nullptr;
+    }
+    // symbols should only be added through here, so that cached lookups are invalidated
+    // a name that's visible through a glob import can't be defined here, as if the import had copied it, and the imported symbol is returned
+    // names that an imported module gains later are visible too, but anything defined here or found in an earlier import takes precedence
+    std::pair<symbol_type*, bool> emplace(sstring name, symbol_type sym) {
+      if (!imports.empty() && !symbols.contains(name)) {
+        llvm::SmallVector<varmap const*, 8> seen = {this};
+        if (auto ptr = get_imported(name, seen)) return {const_cast<symbol_type*>(ptr), false};
+      }
+      auto [it, succ] = symbols.try_emplace(name, std::move(sym));
+      if (succ) added.emplace(name, (*clock)++);
+      return {&it->second, succ};
+    }
+    bool insert(sstring name, symbol_type sym) {return emplace(name, std::move(sym)).second;}
+    // make other's symbols visible from here, and return the names that conflict with symbols already here
+    // other's own symbols are checked against everything visible here, unless this side is smaller and has no imports
+    // modules with the same name are merged by importing one into the other, like the modules themselves
+    std::unordered_set<sstring> import(std::shared_ptr<varmap> const& other) {
       std::unordered_set<sstring> out;
-      if (!imported(other)) {
-        for (auto [name, sym] : other->symbols) {
-          auto [it, succ] = symbols.insert({name, sym});
-          if (!succ) {
-            if (sym.index() == it->second.index() && sym.index() == 2) std::get<2>(it->second)->include(std::get<2>(sym).get());
-            else out.insert(name);
-          }
-        }
-        include(other->parent);
+      if (!other || other.get() == this || std::find_if(imports.begin(), imports.end(), [&] (auto const& i) {return i.first == other;}) != imports.end()) return out;
+      auto check = [&out] (sstring name, symbol_type const& mine, symbol_type const& theirs) {
+        if (same_symbol(mine, theirs)) return;
+        if (mine.index() == 2 && theirs.index() == 2) std::get<2>(mine)->import(std::get<2>(theirs));
+        else out.insert(name);
+      };
+      if (imports.empty() && symbols.size() <= other->symbols.size()) {
+        for (auto const& [name, sym] : symbols) if (auto ptr = other->get_here(name)) check(name, sym, *ptr);
+      }
+      else for (auto const& [name, sym] : other->symbols) if (auto ptr = get_here(name)) check(name, *ptr, sym);
+      imports.push_back({other, (*clock)++});
+      return out;
+    }
+  private:
+    bool shown(sstring name, scope_stamp cut) const {
+      if (cut.clock != clock) return true;
+      auto it = added.find(name);
+      return it == added.end() || it->second < cut.gen;
+    }
+    symbol_ptr get_imported(sstring name, llvm::SmallVectorImpl<varmap const*>& seen, scope_stamp cut = {}) const {
+      for (auto const& [vm, gen] : imports) {
+        if ((cut.clock == clock && gen >= cut.gen) || std::find(seen.begin(), seen.end(), vm.get()) != seen.end()) continue;
+        seen.push_back(vm.get());
+        auto it = vm->symbols.find(name);
+        if (it != vm->symbols.end() && vm->shown(name, cut)) return &it->second;
+        if (auto ptr = vm->get_imported(name, seen, cut)) return ptr;
       }
+      return nullptr;
+    }
+  };
+  // local scopes, all of them share one table mapping each name to a stack of bindings, so lookups don't depend on nesting depth
+  // leaving a scope pops the bindings it added, entering and leaving only allocate while the table is still growing
+  struct symbol_table {
+    struct binding {
+      symbol_type sym;
+      std::size_t depth;
+    };
+    using entry = std::pair<sstring const, std::vector<binding>>;
+    std::unordered_map<sstring, std::vector<binding>> bindings;
+    std::vector<entry*> undo; // entries that were pushed to, in order
+    std::vector<std::size_t> marks; // size of the undo log when each open scope was entered
+    std::vector<std::pair<std::shared_ptr<varmap>, std::size_t>> imports; // glob imports and the depth they were made at
+    std::size_t depth() const noexcept {return marks.size();}
+    void push_scope() {marks.push_back(undo.size());}
+    void pop_scope() {
+      auto mark = marks.back();
+      marks.pop_back();
+      for (; undo.size() > mark; undo.pop_back()) undo.back()->second.pop_back();
+      while (!imports.empty() && imports.back().second > depth()) imports.pop_back();
+    }
+    symbol_ptr get(sstring name, scope_stamp cut = {}) const {
+      auto it = bindings.find(name);
+      auto b = it == bindings.end() || it->second.empty() ? nullptr : &it->second.back();
+      for (auto i = imports.rbegin(); i != imports.rend() && (!b || i->second > b->depth); ++i) if (auto ptr = i->first->get_here(name, cut)) return ptr;
+      return b ? &b->sym : nullptr;
+    }
+    // fails if name is already bound in the innermost scope
+    bool insert(sstring name, symbol_type sym) {
+      auto& e = *bindings.try_emplace(name).first;
+      if (!e.second.empty() && e.second.back().depth == depth()) return false;
+      e.second.push_back({std::move(sym), depth()});
+      undo.push_back(&e);
+      return true;
+    }
+    // glob import into the innermost scope, returns the names that conflict with bindings already in it
+    std::unordered_set<sstring> import(std::shared_ptr<varmap> const& other) {
+      std::unordered_set<sstring> out;
+      for (auto i = marks.empty() ? 0 : marks.back(); i < undo.size(); ++i) if (auto ptr = other->get_here(undo[i]->first); ptr && !same_symbol(*ptr, undo[i]->second.back().sym)) out.insert(undo[i]->first);
+      imports.push_back({other, depth()});
       return out;
-    } 
+    }
   };
 }
 #endif
\ No newline at end of file
@@ -37,10 +37,16 @@ constexpr char aot_help[] = R"(co aot [options] file
 -o <output file>            select output file
 -O<level>                   optimization level
 -l<lib>                     link library
+--no-bounds-checks          don't check array and slice subscripts
+--demand-codegen            only generate functions reachable from main and @export, @link or @linkas definitions
+-s, --signatures            only parse function bodies when they're needed
 )";
 constexpr char jit_help[] = R"(co jit [options] file
 -O<level>                   optimization level
 -l<lib>                     link library
+--no-bounds-checks          don't check array and slice subscripts
+--demand-codegen            only generate functions reachable from main and @export, @link or @linkas definitions
+-s, --signatures            only parse function bodies when they're needed
 )";
 constexpr char build_help[] = R"(co build [options] [root]
 [root] can the project file or the path to the directory containing it. It defaults to the current directory, searching upwards if a project file is not found.
@@ -54,6 +60,9 @@ tokens are printed as file:line:col: data, where data will be printed as hex for
 )";
 constexpr char parse_help[] = R"(co parse file1, file2...
 -c                          interpret next argument as code to parse
+-s, --signatures            only parse declarations, leaving function bodies unparsed
+--emit-ast <file>           write the AST in binary form to file instead of printing it
+files ending in .coast are loaded as binary ASTs
 )";
 std::size_t len(cobalt::token const& tok) {return tok.loc.file.size() + long(std::log10(tok.loc.line) + 1) + long(std::log10(tok.loc.col) + 1);}
 void pretty_print(llvm::raw_ostream& os, std::size_t sz, cobalt::token const& tok) {
@@ -75,6 +84,14 @@ void pretty_print(llvm::raw_ostream& os, std::size_t sz, cobalt::token const& to
   }
   os << '\n';
 }
+// long options that set compile flags, shared by the subcommands that parse or compile code
+bool compile_flag(std::string_view opt, cobalt::flags_t& flags) {
+  if (opt == "signatures") flags.lazy_bodies = true;
+  else if (opt == "no-bounds-checks") flags.bounds_checks = false;
+  else if (opt == "demand-codegen") flags.demand_codegen = true;
+  else return false;
+  return true;
+}
 template <int code> int cleanup() {llvm::errs().flush(); return code;}
 llvm::raw_ostream& warn() {return llvm::errs().changeColor(llvm::raw_ostream::YELLOW, true).write("warning: ", 9).resetColor();}
 llvm::raw_ostream& error() {return llvm::errs().changeColor(llvm::raw_ostream::RED, true).write("error: ", 7).resetColor();}
@@ -161,21 +178,68 @@ co help [category]
     cobalt::default_handler_t handler;
     flags.onerror = handler;
     bool fail = false;
+    std::string_view emit_ast = "";
+    // flags apply to every input, wherever they are on the command line
+    for (auto it = argv + 2; it != argv + argc; ++it) {
+      std::string_view flag = *it;
+      if (flag == "-c") {
+        if (it + 1 != argv + argc) ++it;
+        continue;
+      }
+      if (flag == "-s") flag = "--signatures";
+      if (flag.starts_with("--") && compile_flag(flag.substr(2), flags)) continue;
+      if (flag != "--emit-ast") continue;
+      if (emit_ast.size()) {
+        error() << "redefinition of AST output file\n";
+        return cleanup<1>();
+      }
+      if (++it == argv + argc) {
+        error() << "unspecified AST output file\n";
+        return cleanup<1>();
+      }
+      emit_ast = *it;
+    }
+    bool parsed = false;
     for (auto it = argv + 2; it != argv + argc; ++it) {
       handler = cobalt::default_handler;
       std::string_view file = *it;
+      if (file == "-s" || (file.starts_with("--") && compile_flag(file.substr(2), flags))) continue;
+      if (file == "--emit-ast") {
+        ++it;
+        continue;
+      }
+      if (emit_ast.size() && std::exchange(parsed, true)) {
+        error() << "--emit-ast can only be used with one input\n";
+        return cleanup<1>();
+      }
       std::vector<cobalt::token> toks;
-      if (file == "-c") toks = cobalt::tokenize(*++it, cobalt::sstring::get("<command line>"));
+      cobalt::AST ast = nullptr;
+      if (file == "-c") {
+        toks = cobalt::tokenize(*++it, cobalt::sstring::get("<command line>"));
+        ast = cobalt::parse({toks.begin(), toks.end()}, flags);
+      }
+      else if (file.ends_with(".coast")) ast = cobalt::load_ast(file, flags);
       else {
         auto eo = llvm::MemoryBuffer::getFileOrSTDIN(file);
-        if (eo) toks = cobalt::tokenize(eo.get()->getBuffer(), cobalt::sstring::get(file == "-" ? "<stdin>" : file), flags);
+        if (eo) {
+          toks = cobalt::tokenize(eo.get()->getBuffer(), cobalt::sstring::get(file == "-" ? "<stdin>" : file), flags);
+          ast = cobalt::parse({toks.begin(), toks.end()}, flags);
+        }
         else {
           error() << "error opening " << file << ": " << eo.getError().message() << '\n';
           fail = true;
         }
       }
-      auto ast = cobalt::parse({toks.begin(), toks.end()}, flags);
-      ast.print(llvm::outs());
+      if (emit_ast.size()) {
+        std::error_code ec;
+        llvm::raw_fd_ostream os(emit_ast, ec);
+        if (ec) {
+          error() << "error opening " << emit_ast << ": " << ec.message() << '\n';
+          return cleanup<1>();
+        }
+        cobalt::serialize(ast, os);
+      }
+      else ast.print(llvm::outs());
       fail |= handler.errors;
     }
     return fail;
@@ -272,6 +336,8 @@ co help [category]
     ast_err  = std::exchange(h.errors, 0);
     ast_crit = std::exchange(h.critical, false);
     cobalt::compile_context ctx{std::string(pretty_src)};
+    cobalt::annotate(ast, ctx);
+    cobalt::fold(ast, ctx);
     ast(ctx);
     ll_warn = h.warnings;
     ll_err  = h.errors;
@@ -333,6 +399,7 @@ co help [category]
     std::vector<std::string_view> linked;
     enum {UNSPEC, LLVM, ASM, BC, OBJ} output_type = UNSPEC;
     enum {DEFAULT, QUIET, WERROR} error_type = DEFAULT;
+    cobalt::flags_t flags = cobalt::default_flags;
     auto triple = llvm::sys::getDefaultTargetTriple();
     for (char** it = argv + 2; it < argv + argc; ++it) {
       std::string_view cmd = *it;
@@ -365,6 +432,7 @@ co help [category]
               if (error_type != DEFAULT) warn() << "redefinition or override of error mode\n";
               error_type = QUIET;
             }
+            else if (compile_flag(cmd, flags)) {}
             else if (cmd == "werrror") {
               if (error_type != DEFAULT) warn() << "redefinition or override of error mode\n";
               error_type = WERROR;
@@ -389,6 +457,7 @@ co help [category]
           default:
             for (char c : cmd) switch (c) {
               case 'O': error() << "-O flag must not be specified with any other flags\n"; return cleanup<1>();
+              case 's': flags.lazy_bodies = true; break;
               case 'l':
                 ++it;
                 if (it == argv + argc) {
@@ -466,7 +535,6 @@ co help [category]
       return cleanup<1>();
     }
     std::string_view code{f.get()->getBuffer().data(), f.get()->getBufferSize()};
-    cobalt::flags_t flags = cobalt::default_flags;
     bool* critical = &cobalt::default_handler.critical;
     switch (error_type) {
       case DEFAULT: break;
@@ -479,10 +547,17 @@ co help [category]
         critical = &cobalt::werror_handler.critical;
         break;
     }
-    auto toks = cobalt::tokenize(code, cobalt::sstring::get(input), flags);
-    if (*critical) return cleanup<2>();
-    cobalt::AST ast = cobalt::parse({toks.begin(), toks.end()}, flags);
-    cobalt::compile_context ctx{std::string(input)};
+    std::vector<cobalt::token> toks;
+    cobalt::AST ast = nullptr;
+    if (input.ends_with(".coast")) ast = cobalt::deserialize(code, flags);
+    else {
+      toks = cobalt::tokenize(code, cobalt::sstring::get(input), flags);
+      if (*critical) return cleanup<2>();
+      ast = cobalt::parse({toks.begin(), toks.end()}, flags);
+    }
+    cobalt::compile_context ctx{std::string(input), flags};
+    cobalt::annotate(ast, ctx);
+    cobalt::fold(ast, ctx);
     ast(ctx);
     std::error_code ec;
     llvm::InitializeAllTargetInfos();
@@ -590,6 +665,7 @@ co help [category]
     std::uint8_t opt_lvl = -1;
     std::vector<std::pair<std::string_view, bool>> linked;
     enum {DEFAULT, QUIET, WERROR} error_type = DEFAULT;
+    cobalt::flags_t flags = cobalt::default_flags;
     std::vector<std::string_view> link_dirs = {"/usr/local/lib", "/usr/lib/", "/lib"};
     std::size_t first_idx = 0;
     for (char** it = argv + 2; !first_idx && it < argv + argc; ++it) {
@@ -611,6 +687,7 @@ co help [category]
               if (error_type != DEFAULT) warn() << "redefinition or override of error mode\n";
               error_type = QUIET;
             }
+            else if (compile_flag(cmd, flags)) {}
             else if (cmd == "werrror") {
               if (error_type != DEFAULT) warn() << "redefinition or override of error mode\n";
               error_type = WERROR;
@@ -635,6 +712,7 @@ co help [category]
           default:
             for (char c : cmd) switch (c) {
               case 'O': error() << "-O flag must not be specified with any other flags\n"; return cleanup<1>();
+              case 's': flags.lazy_bodies = true; break;
               case 'l':
                 ++it;
                 if (it == argv + argc) {
@@ -665,7 +743,6 @@ co help [category]
       return cleanup<1>();
     }
     std::string_view code{f.get()->getBuffer().data(), f.get()->getBufferSize()};
-    cobalt::flags_t flags = cobalt::default_flags;
     bool* critical = &cobalt::default_handler.critical;
     switch (error_type) {
       case DEFAULT: break;
@@ -678,10 +755,17 @@ co help [category]
         critical = &cobalt::werror_handler.critical;
         break;
     }
-    auto toks = cobalt::tokenize(code, cobalt::sstring::get(input), flags);
-    if (*critical) return cleanup<2>();
-    cobalt::AST ast = cobalt::parse({toks.begin(), toks.end()}, flags);
-    cobalt::compile_context ctx{std::string(input)};
+    std::vector<cobalt::token> toks;
+    cobalt::AST ast = nullptr;
+    if (input.ends_with(".coast")) ast = cobalt::deserialize(code, flags);
+    else {
+      toks = cobalt::tokenize(code, cobalt::sstring::get(input), flags);
+      if (*critical) return cleanup<2>();
+      ast = cobalt::parse({toks.begin(), toks.end()}, flags);
+    }
+    cobalt::compile_context ctx{std::string(input), flags};
+    cobalt::annotate(ast, ctx);
+    cobalt::fold(ast, ctx);
     ast(ctx);
     std::error_code ec;
     llvm::InitializeAllTargetInfos();
@@ -804,6 +888,11 @@ co help [category]
       llvm::errs() << err << '\n';
       return cleanup<6>();
     }
+    // globals that couldn't be initialized at compile time are initialized by constructors
+    if (auto err = jit->initialize(jit->getMainJITDylib())) {
+      llvm::errs() << err << '\n';
+      return cleanup<6>();
+    }
     llvm::orc::ExecutorAddr addr;
     if (auto err = jit->lookup("main").moveInto(addr)) {
       llvm::errs() << err << '\n';
@@ -3,44 +3,84 @@
 using namespace cobalt;
 using enum types::type_base::kind_t;
 const static auto f16 = sstring::get("f16"), f32 = sstring::get("f32"), f64 = sstring::get("f64"), f128 = sstring::get("f128"), isize = sstring::get("isize"), usize = sstring::get("usize"), bool_ = sstring::get("bool"), null = sstring::get("null");
-type_ptr get_call(type_ptr t, std::vector<type_ptr> const& args) {return nullptr;}
 type_ptr get_sub(type_ptr t, std::vector<type_ptr> const& args) {
   switch (t->kind) {
     case REFERENCE: return get_sub(static_cast<types::reference const*>(t)->base, args);
     case POINTER: return types::reference::get(static_cast<types::pointer const*>(t)->base);
+    case SOA: return static_cast<types::soa const*>(t)->elem;
+    case ARRAY: return types::reference::get(static_cast<types::array const*>(t)->elem);
+    case SLICE: return types::reference::get(static_cast<types::slice const*>(t)->elem);
+    case VECTOR: {
+      // one index extracts an element, more shuffle the elements into a new vector
+      auto elem = static_cast<types::vector const*>(t)->elem;
+      return args.size() == 1 ? elem : types::vector::get(elem, args.size());
+    }
     default: return nullptr;
   }
 }
-type_ptr get_unary(type_ptr t, sstring op) {
-  if (op == "!") return types::integer::get(1);
-  if (op == "p?" || op == "p!") return nullptr;
+type_ptr get_unary(type_ptr t, op_t op) {
+  if (auto v = types::vector::of(t)) switch (op) {
+    case OP_PLUS: case OP_MINUS: return v;
+    case OP_TILDE: return v->elem->kind == INTEGER ? v : nullptr;
+    case OP_BANG: return types::vector::get(types::integer::get(1), v->count);
+    default: return nullptr;
+  }
+  switch (op) {
+    case OP_BANG: return types::integer::get(1);
+    case OP_POST_QUESTION: case OP_POST_BANG: {
+      if (t->kind == REFERENCE) t = static_cast<types::reference const*>(t)->base;
+      if (t->kind != VARIANT) return nullptr;
+      auto ot = static_cast<types::variant const*>(t)->optional_of();
+      if (!ot) return nullptr;
+      return op == OP_POST_QUESTION ? types::integer::get(1) : ot;
+    }
+    default: break;
+  }
   switch (t->kind) {
     case INTEGER:
-      if (op == "~") return t;
-    case FLOAT:
-      if (op == "+" || op == "-" || op == "++" || op == "--") return t;
-      return nullptr;
-    case POINTER:
-      if (op == "*") return types::reference::get(static_cast<types::pointer const*>(t)->base);
-      if (op == "++" || op == "--") return t;
-      return nullptr;
-      break;
+      if (op == OP_TILDE) return t;
+    case FLOAT: switch (op) {
+      case OP_PLUS: case OP_MINUS: case OP_INC: case OP_DEC: return t;
+      default: return nullptr;
+    }
+    case POINTER: switch (op) {
+      case OP_STAR: return types::reference::get(static_cast<types::pointer const*>(t)->base);
+      case OP_INC: case OP_DEC: return t;
+      default: return nullptr;
+    }
     case REFERENCE:
-      if (op == "&") return types::pointer::get(static_cast<types::reference const*>(t)->base);
-      return get_unary(static_cast<types::reference const*>(t), op);
+      if (op == OP_AMP) return types::pointer::get(static_cast<types::reference const*>(t)->base);
+      return get_unary(static_cast<types::reference const*>(t)->base, op);
     case NULLTYPE: return nullptr;
     case FUNCTION:
-      if (op == "&") return t;
+      if (op == OP_AMP) return t;
       return nullptr;
-    case CUSTOM: return nullptr;
+    case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
   }
 }
-type_ptr get_binary(type_ptr lhs, type_ptr rhs, sstring op) {
-  if (op == "&&" || op == "||") return rhs;
+type_ptr get_binary(type_ptr lhs, type_ptr rhs, op_t op) {
+  if (op == OP_LAND || op == OP_LOR) return rhs;
+  if (types::vector::of(lhs) || types::vector::of(rhs)) {
+    // scalars are splatted, but vectors of different types have to be converted first
+    auto lv = types::vector::of(lhs), rv = types::vector::of(rhs);
+    if (lv && rv && lv != rv) return nullptr;
+    auto v = lv ? lv : rv;
+    if (!lv || !rv) {
+      auto s = lv ? rhs : lhs;
+      if (s->kind == REFERENCE) s = static_cast<types::reference const*>(s)->base;
+      if (s->kind != INTEGER && s->kind != FLOAT) return nullptr;
+    }
+    switch (op) {
+      case OP_PLUS: case OP_MINUS: case OP_STAR: case OP_SLASH: case OP_PERCENT: return v;
+      case OP_AMP: case OP_PIPE: case OP_CARET: case OP_SHL: case OP_SHR: return v->elem->kind == INTEGER ? v : nullptr;
+      case OP_EQ: case OP_NE: case OP_LT: case OP_LE: case OP_GT: case OP_GE: return types::vector::get(types::integer::get(1), v->count);
+      default: return nullptr;
+    }
+  }
   switch (lhs->kind) {
     case INTEGER: switch (rhs->kind) {
-      case INTEGER:
-        if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%") {
+      case INTEGER: switch (op) {
+        case OP_PLUS: case OP_MINUS: case OP_STAR: case OP_SLASH: case OP_PERCENT: {
           auto l = static_cast<types::integer const*>(lhs)->nbits, r = static_cast<types::integer const*>(rhs)->nbits;
           if (l < 0) {
             if (r < 0) return types::integer::get(l < r ? -l : -r, true);
@@ -51,57 +91,57 @@ type_ptr get_binary(type_ptr lhs, type_ptr rhs, sstring op) {
             else return types::integer::get(l < r ? r : l, false);
           }
         }
-        if (op == "&" || op == "|" || op == "^") {
+        case OP_AMP: case OP_PIPE: case OP_CARET: {
           auto l = static_cast<types::integer const*>(lhs)->nbits, r = static_cast<types::integer const*>(rhs)->nbits;
           if (l < 0) l = -l;
           if (r < 0) r = -r;
           return types::integer::get(l < r ? r : l, true);
         }
-        if (op == "<<" || op == ">>") return lhs;
-      case FLOAT:
-        if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%" || op == "^^") return rhs;
-        return nullptr;
-      case POINTER:
-        if (op == "+" || op == "-") return rhs;
-        return nullptr;
+        case OP_SHL: case OP_SHR: return lhs;
+        case OP_POW: return rhs;
+        default: return nullptr;
+      }
+      case FLOAT: switch (op) {
+        case OP_PLUS: case OP_MINUS: case OP_STAR: case OP_SLASH: case OP_PERCENT: case OP_POW: return rhs;
+        default: return nullptr;
+      }
+      case POINTER: return op == OP_PLUS || op == OP_MINUS ? rhs : nullptr;
       case REFERENCE: return get_binary(lhs, static_cast<types::reference const*>(rhs)->base, op);
       case FUNCTION: return nullptr;
       case NULLTYPE: return nullptr;
-      case CUSTOM: return nullptr;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
     }
     case FLOAT: switch (rhs->kind) {
-      case INTEGER:
-        if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%" || op == "^^") return lhs;
-        return nullptr;
-      case FLOAT:
-        if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%" || op == "^^") return lhs->size() < rhs->size() ? rhs : lhs;
-        return nullptr;
+      case INTEGER: switch (op) {
+        case OP_PLUS: case OP_MINUS: case OP_STAR: case OP_SLASH: case OP_PERCENT: case OP_POW: return lhs;
+        default: return nullptr;
+      }
+      case FLOAT: switch (op) {
+        case OP_PLUS: case OP_MINUS: case OP_STAR: case OP_SLASH: case OP_PERCENT: case OP_POW: return lhs->size() < rhs->size() ? rhs : lhs;
+        default: return nullptr;
+      }
       case POINTER: return nullptr;
       case REFERENCE: return get_binary(lhs, static_cast<types::reference const*>(rhs)->base, op);
       case FUNCTION: return nullptr;
       case NULLTYPE: return nullptr;
-      case CUSTOM: return nullptr;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
     }
     case POINTER: switch (rhs->kind) {
-      case INTEGER:
-        if (op == "+" || op == "-") return lhs;
-        return nullptr;
+      case INTEGER: return op == OP_PLUS || op == OP_MINUS ? lhs : nullptr;
       case FLOAT: return nullptr;
-      case POINTER:
-        if (op == "-") return types::integer::get(sizeof(void*) * 8);
-        return nullptr;
+      case POINTER: return op == OP_MINUS ? types::integer::get(sizeof(void*) * 8) : nullptr;
       case REFERENCE: return get_binary(lhs, static_cast<types::reference const*>(rhs)->base, op);
       case FUNCTION: return nullptr;
       case NULLTYPE: return nullptr;
-      case CUSTOM: return nullptr;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
     }
     case REFERENCE: return get_binary(static_cast<types::reference const*>(lhs)->base, rhs, op);
     case FUNCTION: return nullptr;
     case NULLTYPE: return nullptr;
-    case CUSTOM: return nullptr;
+    case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
   }
 }
-static type_ptr get_call(type_ptr self, std::vector<type_ptr>&& args) {
+static type_ptr get_call(type_ptr self, std::vector<type_ptr> const& args) {
   switch (self->kind) {
     case INTEGER:
     case FLOAT:
@@ -111,47 +151,160 @@ static type_ptr get_call(type_ptr self, std::vector<type_ptr>&& args) {
     case REFERENCE: return get_call(static_cast<types::reference const*>(self)->base, args);
     case FUNCTION:
       return static_cast<types::function const*>(self)->ret;
-    case CUSTOM: return nullptr;
+    case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
   }
 }
-static type_ptr parse_type(sstring str) {
+static type_ptr builtin_type(std::string_view str) {
   if (str.empty()) return nullptr;
-  switch (str.back()) {
-    case '&': return types::reference::get(parse_type(sstring::get(str.substr(0, str.size() - 1))));
-    case '*': return types::pointer::get(parse_type(sstring::get(str.substr(0, str.size() - 1))));
-    case '^': return types::borrow::get(parse_type(sstring::get(str.substr(0, str.size() - 1))));
+  if (str == "bool") return types::integer::get(1);
+  if (str == "null") return types::null::get();
+  // vectors are spelled as their element type, an x, and their width
+  if (auto x = str.rfind('x'); x != std::string_view::npos && x + 1 < str.size() && str.find_first_not_of("0123456789", x + 1) == std::string_view::npos) {
+    auto elem = builtin_type(str.substr(0, x));
+    if (!elem || (elem->kind != INTEGER && elem->kind != FLOAT)) return nullptr;
+    unsigned count = 0;
+    for (char c : str.substr(x + 1)) {
+      count *= 10;
+      count += c - '0';
+      if (count > 65536) return nullptr;
+    }
+    return count ? types::vector::get(elem, count) : nullptr;
   }
-  if (str == bool_) return types::integer::get(1);
-  if (str == null) return types::null::get();
   switch (str.front()) {
     case 'i':
-      if (str == isize) return types::integer::get(sizeof(void*) * 8, false);
-      if (str.size() > 1 && str.find_first_not_of("0123456789", 1) == std::string::npos) {
-        unsigned width = 0;
-        for (char c : str.substr(1)) {
-          width *= 10;
-          width += c - '0';
-        }
-        return width ? types::integer::get(width, false) : nullptr;
-      }
-    case 'u':
-      if (str == usize) return types::integer::get(sizeof(void*) * 8, true);
-      if (str.size() > 1 && str.find_first_not_of("0123456789", 1) == std::string::npos) {
-        unsigned width = 0;
-        for (char c : str.substr(1)) {
-          width *= 10;
-          width += c - '0';
-        }
-        return width ? types::integer::get(width, true) : nullptr;
+    case 'u': {
+      bool is_unsigned = str.front() == 'u';
+      if (str == (is_unsigned ? "usize" : "isize")) return types::integer::get(sizeof(void*) * 8, is_unsigned);
+      if (str.size() == 1 || str.find_first_not_of("0123456789", 1) != std::string::npos) return nullptr;
+      unsigned width = 0;
+      for (char c : str.substr(1)) {
+        width *= 10;
+        width += c - '0';
+        if (width > llvm::IntegerType::MAX_INT_BITS) return nullptr;
       }
+      return width ? types::integer::get(width, is_unsigned) : nullptr;
+    }
     case 'f':
-      if (str == f16) return types::float16::get();
-      if (str == f32) return types::float32::get();
-      if (str == f64) return types::float64::get();
-      if (str == f128) return types::float128::get();
+      if (str == "f16") return types::float16::get();
+      if (str == "f32") return types::float32::get();
+      if (str == "f64") return types::float64::get();
+      if (str == "f128") return types::float128::get();
   }
   return nullptr;
 }
+type_ptr cobalt::base_context::parse_type(sstring name) {
+  auto it = type_cache.find(name);
+  if (it != type_cache.end()) return it->second;
+  // anything else is cached until a module in this tree changes, like resolve_cache
+  type_key key {vars, name, visible.gen};
+  if (scoped_type_gen != vars->now()) {
+    scoped_type_cache.clear();
+    scoped_type_gen = vars->now();
+  }
+  else if (auto it = scoped_type_cache.find(key); it != scoped_type_cache.end()) {
+    if (std::none_of(it->second.names.begin(), it->second.names.end(), [&] (sstring n) {return locals.get(n, visible);})) return it->second.type;
+  }
+  auto scope = type_scope::SESSION;
+  llvm::SmallVector<sstring, 1> names;
+  auto t = parse_type(name, scope, names);
+  if (!t) return nullptr;
+  if (scope == type_scope::SESSION) type_cache[name] = t;
+  else if (scope == type_scope::MODULE) scoped_type_cache[key] = {t, std::move(names)};
+  return t;
+}
+type_ptr cobalt::base_context::parse_type(std::string_view name, type_scope& scope, llvm::SmallVectorImpl<sstring>& names) {
+  auto idx = name.find_last_not_of("&*^?");
+  if (idx == std::string::npos) return nullptr;
+  auto t = builtin_type(name.substr(0, idx + 1));
+  if (!t && name[idx] == ']') {
+    // T[] is a slice, T[N] is an array, and anything else is a type argument, like soa[T]
+    std::size_t open = idx, depth = 0;
+    do {
+      if (name[open] == ']') ++depth;
+      else if (name[open] == '[') --depth;
+    } while (depth && open--);
+    if (depth) return nullptr;
+    auto base = name.substr(0, open), arg = name.substr(open + 1, idx - open - 1);
+    if (arg.empty()) {
+      auto elem = parse_type(base, scope, names);
+      if (!elem) return nullptr;
+      t = types::slice::get(elem);
+    }
+    else if (arg.find_first_not_of("0123456789") == std::string::npos) {
+      auto elem = parse_type(base, scope, names);
+      if (!elem) return nullptr;
+      t = types::array::get(elem, std::stoull(std::string(arg)));
+    }
+    else if (base == "soa") {
+      auto elem = parse_type(arg, scope, names);
+      if (!elem || elem->kind != STRUCT) return nullptr;
+      t = types::soa::get(static_cast<types::struct_ const*>(elem));
+    }
+    else return nullptr;
+  }
+  else if (!t) {
+    auto& path = *qpath::get(sstring::get(name.substr(0, idx + 1)));
+    if (path.absolute) scope = std::max(scope, type_scope::MODULE);
+    // a local type shadows the module's for as long as its scope is open, so it isn't cached
+    else if (locals.get(path.segments.front(), visible)) scope = type_scope::LOCAL;
+    else {
+      scope = std::max(scope, type_scope::MODULE);
+      names.push_back(path.segments.front());
+    }
+    auto ptr = resolve(path);
+    if (!ptr || ptr->index() != 1) return nullptr;
+    t = std::get<1>(*ptr);
+  }
+  for (char c : name.substr(idx + 1)) switch (c) {
+    case '&': t = types::reference::get(t); break;
+    case '*': t = types::pointer::get(t); break;
+    case '^': t = types::borrow::get(t); break;
+    case '?': t = types::variant::optional(t); break;
+  }
+  return t;
+}
+symbol_ptr cobalt::base_context::resolve(qpath const& path, std::size_t* fail) const {
+  varmap const* vm = vars;
+  if (path.absolute) while (vm->parent) vm = vm->parent;
+  // locals change with every scope, so only lookups that start in a module are cached
+  auto ptr = path.absolute ? nullptr : locals.get(path.segments.front(), visible);
+  bool cache = !ptr;
+  resolve_key key {vm, &path, visible.gen};
+  if (cache) {
+    if (resolve_gen != vm->now()) {
+      resolve_cache.clear();
+      resolve_gen = vm->now();
+    }
+    else if (auto it = resolve_cache.find(key); it != resolve_cache.end()) return it->second;
+  }
+  auto failed = [&] (std::size_t n) -> symbol_ptr {
+    if (fail) *fail = path.prefix_size(n);
+    return nullptr;
+  };
+  for (std::size_t i = !cache; i < path.segments.size(); ++i) {
+    if (i) {
+      if (ptr->index() != 2) return failed(i);
+      vm = std::get<2>(*ptr).get();
+    }
+    if (!(ptr = vm->get(path.segments[i], visible))) return failed(i + 1);
+  }
+  if (cache) resolve_cache.emplace(key, ptr);
+  return ptr;
+}
+symbol_ptr cobalt::base_context::resolve_var(qpath const& path, std::size_t& nvar, std::size_t* fail) const {
+  std::size_t f;
+  if (auto ptr = resolve(path, &f)) {
+    nvar = path.segments.size();
+    return ptr;
+  }
+  if (fail) *fail = f;
+  if (f == path.name.size()) return nullptr;
+  // resolve stopped at a prefix that isn't a module, if it's a variable then the rest are its fields
+  auto ptr = resolve(path.name.substr(0, f));
+  if (!ptr || ptr->index() != 0) return nullptr;
+  for (nvar = 1; path.prefix_size(nvar) < f; ++nvar);
+  return ptr;
+}
 // flow.hpp
 type_ptr cobalt::ast::top_level_ast::type(base_context& ctx) const {(void)ctx; return nullptr;}
 type_ptr cobalt::ast::group_ast::type(base_context& ctx) const {return insts.empty() ? nullptr : insts.back().type(ctx);}
@@ -160,7 +313,7 @@ type_ptr cobalt::ast::if_ast::type(base_context& ctx) const {auto t = if_true.ty
 type_ptr cobalt::ast::while_ast::type(base_context& ctx) const {return body.type(ctx);}
 type_ptr cobalt::ast::for_ast::type(base_context& ctx) const {return body.type(ctx);}
 // funcs.hpp
-type_ptr cobalt::ast::cast_ast::type(base_context& ctx) const {(void)ctx; return parse_type(target);}
+type_ptr cobalt::ast::cast_ast::type(base_context& ctx) const {return ctx.parse_type(target);}
 type_ptr cobalt::ast::binop_ast::type(base_context& ctx) const {
   auto l = lhs.type(ctx);
   if (!l) return nullptr;
@@ -174,6 +327,11 @@ type_ptr cobalt::ast::unop_ast::type(base_context& ctx) const {
   return get_unary(t, op);
 }
 type_ptr cobalt::ast::subscr_ast::type(base_context& ctx) const {
+  auto t = val.type(ctx);
+  if (auto g = types::generic::of(t)) {
+    auto targs = type_args(ctx);
+    return targs.empty() ? nullptr : g->def->instance_type(targs, ctx);
+  }
   std::vector<type_ptr> targs;
   targs.reserve(args.size());
   for (auto const& arg : args) {
@@ -181,10 +339,50 @@ type_ptr cobalt::ast::subscr_ast::type(base_context& ctx) const {
     if (!t) return nullptr;
     targs.push_back(t);
   }
-  auto t = val.type(ctx);
-  return get_sub(t, targs);
+  return t ? get_sub(t, targs) : nullptr;
+}
+// the type name an expression spells out, like soa[T] for a subscript, or an empty string if it can't be one
+static std::string type_name(AST const& expr) {
+  if (auto n = expr.dyn_cast<ast::varget_ast>()) return std::string(n->name);
+  auto n = expr.dyn_cast<ast::subscr_ast>();
+  if (!n) return "";
+  auto out = type_name(n->val);
+  if (out.empty()) return out;
+  if (n->args.empty()) return out + "[]";
+  out.push_back('[');
+  for (auto const& arg : n->args) {
+    auto i = arg.dyn_cast<ast::integer_ast>();
+    auto a = i ? std::to_string(i->val.getLimitedValue()) : type_name(arg);
+    if (a.empty()) return a;
+    out += a;
+    out += ", ";
+  }
+  out.resize(out.size() - 2);
+  out.push_back(']');
+  return out;
+}
+std::vector<type_ptr> cobalt::ast::subscr_ast::type_args(base_context& ctx) const {
+  std::vector<type_ptr> out;
+  out.reserve(args.size());
+  for (auto const& arg : args) {
+    auto name = type_name(arg);
+    auto t = name.empty() ? nullptr : ctx.parse_type(sstring::get(name));
+    if (!t) return {};
+    out.push_back(t);
+  }
+  return out;
+}
+type_ptr cobalt::ast::call_ast::construct_type(base_context& ctx) const {
+  if (auto n = val.dyn_cast<varget_ast>()) {
+    auto ptr = ctx.resolve(n->name);
+    if (!ptr) return ctx.parse_type(n->name); // builtins like f32x8 aren't in scope
+    return ptr->index() == 1 ? std::get<1>(*ptr) : nullptr;
+  }
+  auto name = type_name(val);
+  return name.empty() ? nullptr : ctx.parse_type(sstring::get(name));
 }
 type_ptr cobalt::ast::call_ast::type(base_context& ctx) const {
+  if (auto self = construct_type(ctx)) return self;
   std::vector<type_ptr> targs;
   targs.reserve(args.size());
   for (auto const& arg : args) {
@@ -193,9 +391,89 @@ type_ptr cobalt::ast::call_ast::type(base_context& ctx) const {
     targs.push_back(t);
   }
   auto t = val.type(ctx);
-  return get_call(t, targs);
+  if (auto g = types::generic::of(t)) {
+    auto deduced = g->def->deduce(targs);
+    t = deduced.empty() ? nullptr : g->def->instance_type(deduced, ctx);
+  }
+  return t ? get_call(t, targs) : nullptr;
+}
+type_ptr cobalt::ast::member_ast::type(base_context& ctx) const {
+  // fields of structure of arrays elements are accessed in place, in their columns
+  if (auto n = val.dyn_cast<subscr_ast>()) if (auto t = n->val.type(ctx); t && types::soa::of(t)) {
+    auto f = types::soa::of(t)->elem->get_field(field);
+    return f ? types::reference::get(f->type) : nullptr;
+  }
+  auto t = val.type(ctx);
+  if (!t) return nullptr;
+  if (auto ft = types::sequence_field(t, field)) return ft;
+  return types::struct_::field_type(t, field);
 }
 type_ptr cobalt::ast::fndef_ast::type(base_context& ctx) const {(void)ctx; return nullptr;}
+// match a parameter's type name against the type of its argument, binding the type parameters that it names
+// untyped integer literals are only bound in the second pass, so that other arguments decide their type first
+static bool unify(std::string_view pattern, type_ptr t, std::vector<sstring> const& tparams, std::vector<type_ptr>& out, bool literals) {
+  if (!pattern.ends_with('&') && t->kind == REFERENCE) t = static_cast<types::reference const*>(t)->base; // by-value parameters take a copy
+  while (!pattern.empty()) {
+    switch (pattern.back()) {
+      case '&':
+        if (t->kind != REFERENCE) return false;
+        t = static_cast<types::reference const*>(t)->base;
+        pattern.remove_suffix(1);
+        continue;
+      case '*':
+        if (t->kind != POINTER) return false;
+        t = static_cast<types::pointer const*>(t)->base;
+        pattern.remove_suffix(1);
+        continue;
+      case ']': {
+        auto open = pattern.rfind('[');
+        if (open == std::string_view::npos) return true;
+        auto arg = pattern.substr(open + 1, pattern.size() - open - 2);
+        if (arg.empty() && t->kind == SLICE) t = static_cast<types::slice const*>(t)->elem;
+        else if (arg.empty() && t->kind == ARRAY) t = static_cast<types::array const*>(t)->elem;
+        else if (!arg.empty() && arg.find_first_not_of("0123456789") == std::string_view::npos && t->kind == ARRAY) {
+          auto at = static_cast<types::array const*>(t);
+          if (std::to_string(at->count) != arg) return false;
+          t = at->elem;
+        }
+        else return true; // other type arguments, like soa[T], aren't deduced
+        pattern = pattern.substr(0, open);
+      } continue;
+      case '^':
+      case '?':
+        return true;
+    }
+    break;
+  }
+  auto it = std::find(tparams.begin(), tparams.end(), pattern);
+  if (it == tparams.end()) return true;
+  auto& slot = out[it - tparams.begin()];
+  if (t->kind == INTEGER && !static_cast<types::integer const*>(t)->nbits) {
+    if (literals && !slot) slot = types::integer::get(64);
+    return true;
+  }
+  if (slot && slot != t) return false;
+  slot = t;
+  return true;
+}
+std::vector<type_ptr> cobalt::ast::fndef_ast::deduce(std::vector<type_ptr> const& args_t) const {
+  if (args_t.size() != args.size()) return {};
+  std::vector<type_ptr> out(tparams.size());
+  for (bool literals : {false, true}) for (std::size_t i = 0; i < args.size(); ++i) if (!unify(args[i].second, args_t[i], tparams, out, literals)) return {};
+  if (std::find(out.begin(), out.end(), nullptr) != out.end()) return {};
+  return out;
+}
+type_ptr cobalt::ast::fndef_ast::instance_type(std::vector<type_ptr> const& targs, base_context& ctx) const {
+  if (targs.size() != tparams.size()) return nullptr;
+  ctx.locals.push_scope();
+  for (std::size_t i = 0; i < tparams.size(); ++i) ctx.locals.insert(tparams[i], targs[i]);
+  std::vector<type_ptr> args_t(args.size());
+  bool valid = true;
+  for (std::size_t i = 0; i < args.size(); ++i) if (!(args_t[i] = ctx.parse_type(args[i].second))) valid = false;
+  auto r = ctx.parse_type(ret);
+  ctx.locals.pop_scope();
+  return valid && r ? types::function::get(r, std::move(args_t)) : nullptr;
+}
 // keyvals.hpp
 type_ptr cobalt::ast::null_ast::type(base_context& ctx) const {(void)ctx; return types::null::get();}
 // literals.hpp
@@ -227,26 +505,77 @@ type_ptr cobalt::ast::char_ast::type(base_context& ctx) const {(void)ctx; return
 type_ptr cobalt::ast::module_ast::type(base_context& ctx) const {(void)ctx; return nullptr;}
 type_ptr cobalt::ast::import_ast::type(base_context& ctx) const {(void)ctx; return nullptr;}
 // vars.hpp
-type_ptr cobalt::ast::vardef_ast::type(base_context& ctx) const {(void)ctx; return nullptr;}
-type_ptr cobalt::ast::mutdef_ast::type(base_context& ctx) const {(void)ctx; return nullptr;}
+// untyped integer literals are stored as i64
+static type_ptr decay_literal(type_ptr t) {return t->kind == INTEGER && !static_cast<types::integer const*>(t)->nbits ? types::integer::get(64) : t;}
+type_ptr cobalt::ast::vardef_ast::type(base_context& ctx) const {
+  auto t = val.type(ctx);
+  if (!t) return nullptr;
+  if (global || std::any_of(annotations.begin(), annotations.end(), [] (std::string const& ann) {return ann.starts_with("static(");})) return types::reference::get(decay_literal(t));
+  return t;
+}
+type_ptr cobalt::ast::mutdef_ast::type(base_context& ctx) const {
+  auto t = val.type(ctx);
+  return t ? types::reference::get(decay_literal(t)) : nullptr;
+}
 type_ptr cobalt::ast::varget_ast::type(base_context& ctx) const {
-  varmap* vm = ctx.vars;
-  if (name.front() == '.') while (vm->parent) vm = vm->parent;
-  std::size_t old = name.front() == '.', idx = name.find('.', 1);
-  while (idx != std::string::npos) {
-    auto local = name.substr(old + 1, idx - old - 1);
-    auto ptr = vm->get(sstring::get(local));
-    old = idx;
-    idx = name.find('.', old);
-    if (ptr) {
-      auto pidx = ptr->index();
-      if (idx == std::string::npos) return pidx == 0 ? std::get<0>(*ptr).type : nullptr;
+  auto const& path = *qpath::get(name);
+  std::size_t nvar;
+  auto ptr = ctx.resolve_var(path, nvar);
+  if (!ptr || ptr->index() != 0) return nullptr;
+  auto t = std::get<0>(*ptr).type;
+  for (auto i = nvar; t && i < path.segments.size(); ++i) t = types::struct_::field_type(t, path.segments[i]);
+  return t;
+}
+// typedefs.hpp
+type_ptr cobalt::ast::structdef_ast::struct_type(base_context& ctx, bool diagnose) const {
+  auto layout = types::struct_::EFFICIENT;
+  bool valid = true, lset = false;
+  for (auto const& ann : annotations) {
+    if (ann.starts_with("layout(")) {
+      if (lset && diagnose) ctx.flags.onerror(loc, "reuse of @layout annotation", ERROR);
+      lset = true;
+      auto arg = std::string_view{ann.data() + 7, ann.size() - 8};
+      if (arg == "c" || arg == "C") layout = types::struct_::C;
+      else if (arg == "efficient" || arg == "Efficient") layout = types::struct_::EFFICIENT;
+      else if (arg == "packed" || arg == "Packed") layout = types::struct_::PACKED;
       else {
-        if (pidx == 2) vm = std::get<2>(*ptr).get();
-        else return nullptr;
+        if (diagnose) ctx.flags.onerror(loc, (llvm::Twine("unknown struct layout '") + arg + "', expected c, efficient, or packed").str(), ERROR);
+        valid = false;
       }
     }
-    else return nullptr;
+    else if (diagnose) ctx.flags.onerror(loc, "unknown annotation @" + ann, ERROR);
   }
-  return nullptr;
+  std::vector<types::struct_::field_spec> fs;
+  fs.reserve(fields.size());
+  for (auto const& f : fields) {
+    auto t = ctx.parse_type(f.type);
+    if (!t) {
+      if (diagnose) ctx.flags.onerror(loc, (llvm::Twine("invalid type name '") + f.type + "' for field '" + f.name + "'").str(), ERROR);
+      valid = false;
+    }
+    auto heat = types::struct_::NORMAL;
+    for (auto const& ann : f.annotations) {
+      auto h = ann == "hot()" ? types::struct_::HOT : ann == "cold()" ? types::struct_::COLD : types::struct_::NORMAL;
+      if (h == types::struct_::NORMAL) {
+        if (diagnose) ctx.flags.onerror(loc, (llvm::Twine("unknown annotation @") + ann + " on field '" + f.name + "'").str(), ERROR);
+      }
+      else if (heat != types::struct_::NORMAL) {
+        if (diagnose) ctx.flags.onerror(loc, (llvm::Twine("field '") + f.name + "' cannot have more than one of @hot and @cold").str(), ERROR);
+      }
+      else heat = h;
+    }
+    fs.push_back({f.name, t, heat});
+  }
+  if (!valid || name.empty()) return nullptr;
+  std::string qual;
+  if (name.front() == '.') qual = name.substr(1);
+  else {
+    for (auto seg : ctx.path) {
+      qual += seg;
+      qual.push_back('.');
+    }
+    qual += name;
+  }
+  return types::struct_::get(sstring::get(qual), fs, layout);
 }
+type_ptr cobalt::ast::structdef_ast::type(base_context& ctx) const {(void)ctx; return nullptr;}
@@ -1,48 +1,13 @@
 #include "cobalt/ast.hpp"
 #include "cobalt/context.hpp"
+#include "cobalt/optimize.hpp"
 #include "cobalt/varmap.hpp"
 #include "cobalt/types.hpp"
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+#include <optional>
 using namespace cobalt;
 using enum types::type_base::kind_t;
-const static auto f16 = sstring::get("f16"), f32 = sstring::get("f32"), f64 = sstring::get("f64"), f128 = sstring::get("f128"), isize = sstring::get("isize"), usize = sstring::get("usize"), bool_ = sstring::get("bool"), null = sstring::get("null");
-static type_ptr parse_type(sstring str) {
-  if (str.empty()) return nullptr;
-  switch (str.back()) {
-    case '&': return types::reference::get(parse_type(sstring::get(str.substr(0, str.size() - 1))));
-    case '*': return types::pointer::get(parse_type(sstring::get(str.substr(0, str.size() - 1))));
-    case '^': return types::borrow::get(parse_type(sstring::get(str.substr(0, str.size() - 1))));
-  }
-  if (str == bool_) return types::integer::get(1);
-  if (str == null) return types::null::get();
-  switch (str.front()) {
-    case 'i':
-      if (str == isize) return types::integer::get(sizeof(void*) * 8, false);
-      if (str.size() > 1 && str.find_first_not_of("0123456789", 1) == std::string::npos) {
-        unsigned width = 0;
-        for (char c : str.substr(1)) {
-          width *= 10;
-          width += c - '0';
-        }
-        return width ? types::integer::get(width, false) : nullptr;
-      }
-    case 'u':
-      if (str == usize) return types::integer::get(sizeof(void*) * 8, true);
-      if (str.size() > 1 && str.find_first_not_of("0123456789", 1) == std::string::npos) {
-        unsigned width = 0;
-        for (char c : str.substr(1)) {
-          width *= 10;
-          width += c - '0';
-        }
-        return width ? types::integer::get(width, true) : nullptr;
-      }
-    case 'f':
-      if (str == f16) return types::float16::get();
-      if (str == f32) return types::float32::get();
-      if (str == f64) return types::float64::get();
-      if (str == f128) return types::float128::get();
-  }
-  return nullptr;
-}
+const static auto f16 = sstring::get("f16"), f32 = sstring::get("f32"), f64 = sstring::get("f64"), f128 = sstring::get("f128"), isize = sstring::get("isize"), usize = sstring::get("usize");
 static std::pair<types::integer const*, bool> is_signed(type_ptr lhs, type_ptr rhs) {
   auto l = static_cast<types::integer const*>(lhs), r = static_cast<types::integer const*>(rhs);
   switch ((int(l->nbits < 0) << 1) | int(r->nbits < 0)) {
@@ -53,9 +18,76 @@ static std::pair<types::integer const*, bool> is_signed(type_ptr lhs, type_ptr r
   }
   return {nullptr, false}; // unreachable
 }
+// converts each element of a vector, explicit conversions can also narrow, convert floats to integers, or reinterpret vectors of the same size
+static llvm::Value* convert_elems(llvm::Value* v, types::vector const* t1, types::vector const* t2, bool expl, location loc, compile_context& ctx) {
+  auto lt = t2->llvm_type(loc, ctx);
+  if (t1->count != t2->count) return expl && t1->elem->size() * t1->count == t2->elem->size() * t2->count ? ctx.builder.CreateBitCast(v, lt) : nullptr;
+  auto e1 = t1->elem, e2 = t2->elem;
+  if (e1->kind == INTEGER) {
+    auto i1 = static_cast<types::integer const*>(e1);
+    bool is_signed = i1->nbits > 1; // bools extend to 1, not -1
+    if (e2->kind == FLOAT) return is_signed ? ctx.builder.CreateSIToFP(v, lt) : ctx.builder.CreateUIToFP(v, lt);
+    auto b1 = i1->bits(), b2 = static_cast<types::integer const*>(e2)->bits();
+    if (b1 == b2) return v;
+    if (b1 < b2) return is_signed ? ctx.builder.CreateSExt(v, lt) : ctx.builder.CreateZExt(v, lt);
+    return expl ? ctx.builder.CreateTrunc(v, lt) : nullptr;
+  }
+  if (e2->kind == INTEGER) return expl ? static_cast<types::integer const*>(e2)->nbits > 0 ? ctx.builder.CreateFPToSI(v, lt) : ctx.builder.CreateFPToUI(v, lt) : nullptr;
+  if (e1->size() == e2->size()) return v;
+  if (e1->size() < e2->size()) return ctx.builder.CreateFPExt(v, lt);
+  return expl ? ctx.builder.CreateFPTrunc(v, lt) : nullptr;
+}
+// values of these types own heap memory, cold parts are the only thing that's allocated for a value
+static bool owns_memory(type_ptr t) {
+  switch (t->kind) {
+    case STRUCT: {
+      auto st = static_cast<types::struct_ const*>(t);
+      return st->cold || std::any_of(st->fields.begin(), st->fields.end(), [] (auto const& f) {return owns_memory(f.type);});
+    }
+    case ARRAY: return owns_memory(static_cast<types::array const*>(t)->elem);
+    default: return false;
+  }
+}
 static llvm::Value* impl_convert(llvm::Value* v, type_ptr t1, type_ptr t2, location loc, compile_context& ctx) {
   if (!(t1 && t2)) return nullptr;
   if (t1 == t2) return v;
+  if (t2->kind == VECTOR) {
+    // scalars are splatted, and vectors are converted elementwise
+    if (t1->kind == REFERENCE) {
+      t1 = static_cast<types::reference const*>(t1)->base;
+      v = ctx.builder.CreateLoad(t1->llvm_type(loc, ctx), v);
+      if (t1 == t2) return v;
+    }
+    auto vt = static_cast<types::vector const*>(t2);
+    if (t1->kind == VECTOR) return convert_elems(v, static_cast<types::vector const*>(t1), vt, false, loc, ctx);
+    if (t1->kind != INTEGER && t1->kind != FLOAT) return nullptr;
+    auto e = impl_convert(v, t1, vt->elem, loc, ctx);
+    return e ? ctx.builder.CreateVectorSplat(vt->count, e) : nullptr;
+  }
+  if (t2->kind == VARIANT) {
+    // values of an alternative are wrapped, and values that convert to an optional's type are converted first
+    if (t1->kind == REFERENCE) {
+      t1 = static_cast<types::reference const*>(t1)->base;
+      v = ctx.builder.CreateLoad(t1->llvm_type(loc, ctx), v);
+      if (t1 == t2) return v;
+    }
+    if (owns_memory(t1)) return nullptr; // a variant couldn't copy or free what the value owns
+    auto vt = static_cast<types::variant const*>(t2);
+    if (vt->index_of(t1) >= 0) return vt->wrap(v, t1, loc, ctx);
+    if (auto ot = vt->optional_of(); ot && t1->kind != VARIANT)
+      if (auto v2 = impl_convert(v, t1, ot, loc, ctx)) return vt->wrap(v2, ot, loc, ctx);
+    return nullptr;
+  }
+  if (t2->kind == SLICE && t1->kind == REFERENCE) {
+    // arrays are borrowed as slices of all of their elements
+    auto at = static_cast<types::reference const*>(t1)->base;
+    if (at->kind == ARRAY && static_cast<types::array const*>(at)->elem == static_cast<types::slice const*>(t2)->elem) {
+      auto i64 = llvm::Type::getInt64Ty(*ctx.context);
+      auto ptr = ctx.builder.CreateConstInBoundsGEP2_64(at->llvm_type(loc, ctx), v, 0, 0);
+      auto out = ctx.builder.CreateInsertValue(llvm::UndefValue::get(t2->llvm_type(loc, ctx)), ptr, {0});
+      return ctx.builder.CreateInsertValue(out, llvm::ConstantInt::get(i64, static_cast<types::array const*>(at)->count), {1});
+    }
+  }
   switch (t1->kind) {
     case INTEGER: switch (t2->kind) {
       case INTEGER: {
@@ -114,7 +146,7 @@ static llvm::Value* impl_convert(llvm::Value* v, type_ptr t1, type_ptr t2, locat
       case REFERENCE: return nullptr;
       case FUNCTION: return nullptr;
       case NULLTYPE: return nullptr;
-      case CUSTOM: return nullptr;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
     }
     case FLOAT: switch (t2->kind) {
       case INTEGER: return nullptr;
@@ -128,7 +160,7 @@ static llvm::Value* impl_convert(llvm::Value* v, type_ptr t1, type_ptr t2, locat
       case REFERENCE: return nullptr;
       case FUNCTION: return nullptr;
       case NULLTYPE: return nullptr;
-      case CUSTOM: return nullptr;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
     }
     case POINTER: return nullptr;
     case REFERENCE: {
@@ -137,12 +169,25 @@ static llvm::Value* impl_convert(llvm::Value* v, type_ptr t1, type_ptr t2, locat
     }
     case NULLTYPE: return nullptr;
     case FUNCTION: return nullptr;
-    case CUSTOM: return nullptr;
+    case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
   }
 }
 static llvm::Value* expl_convert(llvm::Value* v, type_ptr t1, type_ptr t2, location loc, compile_context& ctx) {
   if (!(t1 && t2)) return nullptr;
   if (t1 == t2) return v;
+  if (t2->kind == VARIANT) return impl_convert(v, t1, t2, loc, ctx);
+  if (t2->kind == VECTOR) {
+    if (t1->kind == REFERENCE) {
+      t1 = static_cast<types::reference const*>(t1)->base;
+      v = ctx.builder.CreateLoad(t1->llvm_type(loc, ctx), v);
+      if (t1 == t2) return v;
+    }
+    auto vt = static_cast<types::vector const*>(t2);
+    if (t1->kind == VECTOR) return convert_elems(v, static_cast<types::vector const*>(t1), vt, true, loc, ctx);
+    if (t1->kind != INTEGER && t1->kind != FLOAT) return nullptr;
+    auto e = expl_convert(v, t1, vt->elem, loc, ctx);
+    return e ? ctx.builder.CreateVectorSplat(vt->count, e) : nullptr;
+  }
   switch (t1->kind) {
     case INTEGER: switch (t2->kind) {
       case INTEGER: {
@@ -178,7 +223,7 @@ static llvm::Value* expl_convert(llvm::Value* v, type_ptr t1, type_ptr t2, locat
       case REFERENCE: return nullptr;
       case FUNCTION: return nullptr;
       case NULLTYPE: return nullptr;
-      case CUSTOM: return nullptr;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
     }
     case FLOAT: switch (t2->kind) {
       case INTEGER: {
@@ -194,7 +239,7 @@ static llvm::Value* expl_convert(llvm::Value* v, type_ptr t1, type_ptr t2, locat
       case REFERENCE: return nullptr;
       case FUNCTION: return nullptr;
       case NULLTYPE: return nullptr;
-      case CUSTOM: return nullptr;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
     }
     case POINTER: switch (t2->kind) {
       case INTEGER:
@@ -205,7 +250,7 @@ static llvm::Value* expl_convert(llvm::Value* v, type_ptr t1, type_ptr t2, locat
       case REFERENCE: return nullptr;
       case FUNCTION: return nullptr;
       case NULLTYPE: return nullptr;
-      case CUSTOM: return nullptr;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
     }
     case REFERENCE: {
       auto t = static_cast<types::reference const*>(t1)->base;
@@ -213,353 +258,455 @@ static llvm::Value* expl_convert(llvm::Value* v, type_ptr t1, type_ptr t2, locat
     }
     case NULLTYPE: return nullptr;
     case FUNCTION: return nullptr;
-    case CUSTOM: return nullptr;
+    case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullptr;
   }
 }
-static typed_value unary_op(typed_value tv, std::string_view op, location loc, compile_context& ctx) {
+static typed_value unary_op(typed_value tv, op_t op, location loc, compile_context& ctx) {
   if (!tv.type) return nullval;
   switch (tv.type->kind) {
     case INTEGER:
-      if (op == "+") return tv;
-      if (op == "-") return {ctx.builder.CreateNeg(tv.value), tv.type};
-      if (op == "~") return {ctx.builder.CreateXor(tv.value, -1), tv.type};
-      if (op == "!") return {ctx.builder.CreateIsNull(tv.value), types::integer::get(1)};
+      switch (op) {
+        case OP_PLUS: return tv;
+        case OP_MINUS: return {ctx.builder.CreateNeg(tv.value), tv.type};
+        case OP_TILDE: return {ctx.builder.CreateXor(tv.value, -1), tv.type};
+        case OP_BANG: return {ctx.builder.CreateIsNull(tv.value), types::integer::get(1)};
+        default: break;
+      }
       return nullval;
     case FLOAT:
-      if (op == "+") return tv;
-      if (op == "-") return {ctx.builder.CreateFNeg(tv.value), tv.type};
-      if (op == "!") return {ctx.builder.CreateFCmpOEQ(tv.value, llvm::ConstantFP::getZero(tv.type->llvm_type(loc, ctx))), types::integer::get(1)};
+      switch (op) {
+        case OP_PLUS: return tv;
+        case OP_MINUS: return {ctx.builder.CreateFNeg(tv.value), tv.type};
+        case OP_BANG: return {ctx.builder.CreateFCmpOEQ(tv.value, llvm::ConstantFP::getZero(tv.type->llvm_type(loc, ctx))), types::integer::get(1)};
+        default: break;
+      }
       return nullval;
     case POINTER:
-      if (op == "*") {
-        auto t = static_cast<types::pointer const*>(tv.type)->base;
-        if (t->kind == FUNCTION) return {tv.value, t};
-        else return {tv.value, types::reference::get(t)};
+      switch (op) {
+        case OP_STAR: {
+          auto t = static_cast<types::pointer const*>(tv.type)->base;
+          if (t->kind == FUNCTION) return {tv.value, t};
+          else return {tv.value, types::reference::get(t)};
+        }
+        case OP_BANG: return {ctx.builder.CreateIsNull(tv.value), types::integer::get(1)};
+        default: break;
       }
-      if (op == "!") return {ctx.builder.CreateIsNull(tv.value), types::integer::get(1)};
       return nullval;
     case REFERENCE: {
       auto t = static_cast<types::reference const*>(tv.type)->base;
-      if (op == "&") return {tv.value, types::pointer::get(t)};
+      if (op == OP_AMP) return {tv.value, types::pointer::get(t)};
       switch (t->kind) {
         case INTEGER:
-          if (op == "++") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v1 = ctx.builder.CreateLoad(t2, tv.value);
-            auto v2 = ctx.builder.CreateAdd(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, tv.value);
-            return {v3, tv.type};
-          }
-          if (op == "--") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v1 = ctx.builder.CreateLoad(t2, tv.value);
-            auto v2 = ctx.builder.CreateSub(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, tv.value);
-            return {v3, tv.type};
+          switch (op) {
+            case OP_INC: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v1 = ctx.builder.CreateLoad(t2, tv.value);
+              auto v2 = ctx.builder.CreateAdd(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, tv.value);
+              return {v3, tv.type};
+            }
+            case OP_DEC: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v1 = ctx.builder.CreateLoad(t2, tv.value);
+              auto v2 = ctx.builder.CreateSub(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, tv.value);
+              return {v3, tv.type};
+            }
+            default: break;
           }
           break;
         case FLOAT:
-          if (op == "++") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v1 = ctx.builder.CreateLoad(t2, tv.value);
-            auto v2 = ctx.builder.CreateFAdd(v1, llvm::ConstantFP::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, tv.value);
-            return {v3, tv.type};
-          }
-          if (op == "--") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v1 = ctx.builder.CreateLoad(t2, tv.value);
-            auto v2 = ctx.builder.CreateFSub(v1, llvm::ConstantFP::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, tv.value);
-            return {v3, tv.type};
+          switch (op) {
+            case OP_INC: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v1 = ctx.builder.CreateLoad(t2, tv.value);
+              auto v2 = ctx.builder.CreateFAdd(v1, llvm::ConstantFP::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, tv.value);
+              return {v3, tv.type};
+            }
+            case OP_DEC: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v1 = ctx.builder.CreateLoad(t2, tv.value);
+              auto v2 = ctx.builder.CreateFSub(v1, llvm::ConstantFP::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, tv.value);
+              return {v3, tv.type};
+            }
+            default: break;
           }
           break;
         case POINTER:
-          if (op == "++") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
-            auto v1 = ctx.builder.CreateLoad(t2, tv.value);
-            auto v2 = ctx.builder.CreateBitCast(v1, t3);
-            auto v3 = ctx.builder.CreateAdd(v2, llvm::ConstantInt::get(t3, 1));
-            auto v4 = ctx.builder.CreateBitCast(v1, t2);
-            auto v5 = ctx.builder.CreateStore(v4, tv.value);
-            return {v5, tv.type};
-          }
-          if (op == "--") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
-            auto v1 = ctx.builder.CreateLoad(t2, tv.value);
-            auto v2 = ctx.builder.CreateBitCast(v1, t3);
-            auto v3 = ctx.builder.CreateSub(v2, llvm::ConstantInt::get(t3, 1));
-            auto v4 = ctx.builder.CreateBitCast(v1, t2);
-            auto v5 = ctx.builder.CreateStore(v4, tv.value);
-            return {v5, tv.type};
+          switch (op) {
+            case OP_INC: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
+              auto v1 = ctx.builder.CreateLoad(t2, tv.value);
+              auto v2 = ctx.builder.CreateBitCast(v1, t3);
+              auto v3 = ctx.builder.CreateAdd(v2, llvm::ConstantInt::get(t3, 1));
+              auto v4 = ctx.builder.CreateBitCast(v1, t2);
+              auto v5 = ctx.builder.CreateStore(v4, tv.value);
+              return {v5, tv.type};
+            }
+            case OP_DEC: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
+              auto v1 = ctx.builder.CreateLoad(t2, tv.value);
+              auto v2 = ctx.builder.CreateBitCast(v1, t3);
+              auto v3 = ctx.builder.CreateSub(v2, llvm::ConstantInt::get(t3, 1));
+              auto v4 = ctx.builder.CreateBitCast(v1, t2);
+              auto v5 = ctx.builder.CreateStore(v4, tv.value);
+              return {v5, tv.type};
+            }
+            default: break;
           }
           break;
         case REFERENCE: break;
         case FUNCTION: break;
         case NULLTYPE: break;
-        case CUSTOM: break;
+        case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: break;
       }
       return unary_op({ctx.builder.CreateLoad(t->llvm_type(loc, ctx), tv.value), t}, op, loc, ctx);
     }
     case FUNCTION:
-      if (op == "&") return {ctx.builder.CreateBitCast(tv.value, llvm::Type::getInt8PtrTy(*ctx.context)), types::pointer::get(tv.type)};
+      if (op == OP_AMP) return {ctx.builder.CreateBitCast(tv.value, llvm::Type::getInt8PtrTy(*ctx.context)), types::pointer::get(tv.type)};
       return nullval;
     case NULLTYPE: return nullval;
-    case CUSTOM: return nullval;
+    case VARIANT: {
+      auto vt = static_cast<types::variant const*>(tv.type);
+      auto ot = vt->optional_of();
+      if (!ot) return nullval;
+      switch (op) {
+        case OP_POST_QUESTION: return {ctx.builder.CreateICmpEQ(vt->get_tag(tv.value, loc, ctx), ctx.builder.getInt32(vt->index_of(ot))), types::integer::get(1)};
+        case OP_BANG: return {ctx.builder.CreateICmpNE(vt->get_tag(tv.value, loc, ctx), ctx.builder.getInt32(vt->index_of(ot))), types::integer::get(1)};
+        case OP_POST_BANG: {
+          // unwrapping an empty optional traps
+          auto f = ctx.builder.GetInsertBlock()->getParent();
+          auto empty = llvm::BasicBlock::Create(*ctx.context, "empty", f), full = llvm::BasicBlock::Create(*ctx.context, "full", f);
+          ctx.builder.CreateCondBr(ctx.builder.CreateICmpEQ(vt->get_tag(tv.value, loc, ctx), ctx.builder.getInt32(vt->index_of(ot))), full, empty);
+          ctx.builder.SetInsertPoint(empty);
+          ctx.builder.CreateCall(llvm::Intrinsic::getDeclaration(ctx.module.get(), llvm::Intrinsic::trap));
+          ctx.builder.CreateUnreachable();
+          ctx.builder.SetInsertPoint(full);
+          return {vt->unwrap(tv.value, ot, loc, ctx), ot};
+        }
+        default: return nullval;
+      }
+    }
+    case VECTOR: {
+      auto vt = static_cast<types::vector const*>(tv.type);
+      bool is_int = vt->elem->kind == INTEGER;
+      switch (op) {
+        case OP_PLUS: return tv;
+        case OP_MINUS: return {is_int ? ctx.builder.CreateNeg(tv.value) : ctx.builder.CreateFNeg(tv.value), tv.type};
+        case OP_TILDE: return is_int ? typed_value{ctx.builder.CreateNot(tv.value), tv.type} : nullval;
+        case OP_BANG: return {is_int ? ctx.builder.CreateIsNull(tv.value) : ctx.builder.CreateFCmpOEQ(tv.value, llvm::Constant::getNullValue(tv.value->getType())), types::vector::get(types::integer::get(1), vt->count)};
+        default: return nullval;
+      }
+    }
+    case ARRAY: case SLICE: case STRUCT: case SOA: case ENUM: case CUSTOM: return nullval;
+  }
+}
+// elementwise operators on vectors, scalar operands are splatted to the other operand's type
+static typed_value vector_op(typed_value lhs, typed_value rhs, op_t op, location loc, compile_context& ctx) {
+  auto lt = types::vector::of(lhs.type), rt = types::vector::of(rhs.type);
+  if (lt && rt && lt != rt) return nullval;
+  auto t = lt ? lt : rt;
+  auto l = impl_convert(lhs.value, lhs.type, t, loc, ctx);
+  if (!l) return nullval;
+  auto r = impl_convert(rhs.value, rhs.type, t, loc, ctx);
+  if (!r) return nullval;
+  bool is_int = t->elem->kind == INTEGER, is_signed = is_int && static_cast<types::integer const*>(t->elem)->nbits > 0;
+  auto cmp = [&] (llvm::CmpInst::Predicate s, llvm::CmpInst::Predicate u, llvm::CmpInst::Predicate f) -> typed_value {
+    return {is_int ? ctx.builder.CreateICmp(is_signed ? s : u, l, r) : ctx.builder.CreateFCmp(f, l, r), types::vector::get(types::integer::get(1), t->count)};
+  };
+  switch (op) {
+    case OP_PLUS: return {is_int ? ctx.builder.CreateAdd(l, r) : ctx.builder.CreateFAdd(l, r), t};
+    case OP_MINUS: return {is_int ? ctx.builder.CreateSub(l, r) : ctx.builder.CreateFSub(l, r), t};
+    case OP_STAR: return {is_int ? ctx.builder.CreateMul(l, r) : ctx.builder.CreateFMul(l, r), t};
+    case OP_SLASH: return {is_int ? is_signed ? ctx.builder.CreateSDiv(l, r) : ctx.builder.CreateUDiv(l, r) : ctx.builder.CreateFDiv(l, r), t};
+    case OP_PERCENT: return {is_int ? is_signed ? ctx.builder.CreateSRem(l, r) : ctx.builder.CreateURem(l, r) : ctx.builder.CreateFRem(l, r), t};
+    case OP_AMP: return is_int ? typed_value{ctx.builder.CreateAnd(l, r), t} : nullval;
+    case OP_PIPE: return is_int ? typed_value{ctx.builder.CreateOr(l, r), t} : nullval;
+    case OP_CARET: return is_int ? typed_value{ctx.builder.CreateXor(l, r), t} : nullval;
+    case OP_SHL: return is_int ? typed_value{ctx.builder.CreateShl(l, r), t} : nullval;
+    case OP_SHR: return is_int ? typed_value{is_signed ? ctx.builder.CreateAShr(l, r) : ctx.builder.CreateLShr(l, r), t} : nullval;
+    case OP_EQ: return cmp(llvm::CmpInst::ICMP_EQ, llvm::CmpInst::ICMP_EQ, llvm::CmpInst::FCMP_OEQ);
+    case OP_NE: return cmp(llvm::CmpInst::ICMP_NE, llvm::CmpInst::ICMP_NE, llvm::CmpInst::FCMP_UNE);
+    case OP_LT: return cmp(llvm::CmpInst::ICMP_SLT, llvm::CmpInst::ICMP_ULT, llvm::CmpInst::FCMP_OLT);
+    case OP_LE: return cmp(llvm::CmpInst::ICMP_SLE, llvm::CmpInst::ICMP_ULE, llvm::CmpInst::FCMP_OLE);
+    case OP_GT: return cmp(llvm::CmpInst::ICMP_SGT, llvm::CmpInst::ICMP_UGT, llvm::CmpInst::FCMP_OGT);
+    case OP_GE: return cmp(llvm::CmpInst::ICMP_SGE, llvm::CmpInst::ICMP_UGE, llvm::CmpInst::FCMP_OGE);
+    default: return nullval;
   }
 }
-static typed_value binary_op(typed_value lhs, typed_value rhs, std::string_view op, location loc, compile_context& ctx) {
+static typed_value binary_op(typed_value lhs, typed_value rhs, op_t op, location loc, compile_context& ctx) {
   if (!lhs.type) return nullval;
   if (!rhs.type) return nullval;
+  if (types::vector::of(lhs.type) || types::vector::of(rhs.type)) return vector_op(lhs, rhs, op, loc, ctx);
   switch (lhs.type->kind) {
     case INTEGER: switch (rhs.type->kind) {
       case INTEGER:
-        if (op == "+") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateAdd(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateAdd(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateAdd(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateAdd(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+        switch (op) {
+          case OP_PLUS: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateAdd(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateAdd(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateAdd(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateAdd(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
-        }
-        if (op == "-") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateSub(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateSub(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateSub(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateSub(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+          case OP_MINUS: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateSub(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateSub(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateSub(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateSub(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
-        }
-        if (op == "*") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateMul(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateMul(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateMul(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateMul(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+          case OP_STAR: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateMul(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateMul(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateMul(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateMul(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
-        }
-        if (op == "/") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateSDiv(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateSDiv(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateSDiv(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateUDiv(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+          case OP_SLASH: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateSDiv(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateSDiv(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateSDiv(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateUDiv(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
-        }
-        if (op == "%") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateSRem(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateSRem(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateSRem(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateURem(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+          case OP_PERCENT: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateSRem(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateSRem(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateSRem(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateURem(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
-        }
-        if (op == "&") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateAnd(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateAnd(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateAnd(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateAnd(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+          case OP_AMP: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateAnd(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateAnd(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateAnd(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateAnd(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
-        }
-        if (op == "|") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateOr(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateOr(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateOr(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateOr(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+          case OP_PIPE: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateOr(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateOr(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateOr(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateOr(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
-        }
-        if (op == "^") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateXor(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateXor(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateXor(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateXor(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+          case OP_CARET: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateXor(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateXor(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateXor(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateXor(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
-        }
-        if (op == "<<") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateShl(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateShl(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateShl(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateShl(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+          case OP_SHL: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateShl(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateShl(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateShl(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateShl(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
-        }
-        if (op == ">>") {
-          auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
-          switch ((int(lb < 0) << 1) | int(rb < 0)) {
-            case 0: return {ctx.builder.CreateLShr(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
-            case 1: return {ctx.builder.CreateLShr(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
-            case 2: return {ctx.builder.CreateLShr(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
-            case 3: return {ctx.builder.CreateLShr(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+          case OP_SHR: {
+            auto lb = static_cast<types::integer const*>(lhs.type)->nbits, rb = static_cast<types::integer const*>(rhs.type)->nbits;
+            switch ((int(lb < 0) << 1) | int(rb < 0)) {
+              case 0: return {ctx.builder.CreateLShr(lhs.value, rhs.value), lb > rb ? lhs.type : rhs.type};
+              case 1: return {ctx.builder.CreateLShr(lhs.value, rhs.value), lb > -rb ? lhs.type : rhs.type};
+              case 2: return {ctx.builder.CreateLShr(lhs.value, rhs.value), -lb > rb ? lhs.type : rhs.type};
+              case 3: return {ctx.builder.CreateLShr(lhs.value, rhs.value), lb < rb ? lhs.type : rhs.type};
+            }
+            return nullval; // unreachable
           }
-          return nullval; // unreachable
+          default: break;
         }
         return nullval;
       case FLOAT:
-        if (op == "+") {
-          auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFAdd(v0, rhs.value);
-          return {v1, rhs.type};
-        }
-        if (op == "-") {
-          auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFSub(v0, rhs.value);
-          return {v1, rhs.type};
-        }
-        if (op == "*") {
-          auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFMul(v0, rhs.value);
-          return {v1, rhs.type};
-        }
-        if (op == "/") {
-          auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFDiv(v0, rhs.value);
-          return {v1, rhs.type};
-        }
-        if (op == "%") {
-          auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFRem(v0, rhs.value);
-          return {v1, rhs.type};
+        switch (op) {
+          case OP_PLUS: {
+            auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFAdd(v0, rhs.value);
+            return {v1, rhs.type};
+          }
+          case OP_MINUS: {
+            auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFSub(v0, rhs.value);
+            return {v1, rhs.type};
+          }
+          case OP_STAR: {
+            auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFMul(v0, rhs.value);
+            return {v1, rhs.type};
+          }
+          case OP_SLASH: {
+            auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFDiv(v0, rhs.value);
+            return {v1, rhs.type};
+          }
+          case OP_PERCENT: {
+            auto v0 = impl_convert(lhs.value, lhs.type, rhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFRem(v0, rhs.value);
+            return {v1, rhs.type};
+          }
+          default: break;
         }
         return nullval;
       case POINTER:
-        if (op == "+") {
-          auto t2 = rhs.type->llvm_type(loc, ctx);
-          auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
-          auto v0 = impl_convert(lhs.value, lhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
-          auto v1 = ctx.builder.CreateBitCast(rhs.value, t3);
-          auto v2 = ctx.builder.CreateAdd(v1, v0);
-          auto v3 = ctx.builder.CreateBitCast(v2, t2);
-          return {v3, rhs.type};
-        }
-        if (op == "-") {
-          auto t2 = rhs.type->llvm_type(loc, ctx);
-          auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
-          auto v0 = impl_convert(lhs.value, lhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
-          auto v1 = ctx.builder.CreateBitCast(rhs.value, t3);
-          auto v2 = ctx.builder.CreateSub(v1, v0);
-          auto v3 = ctx.builder.CreateBitCast(v2, t2);
-          return {v3, rhs.type};
+        switch (op) {
+          case OP_PLUS: {
+            auto t2 = rhs.type->llvm_type(loc, ctx);
+            auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
+            auto v0 = impl_convert(lhs.value, lhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
+            auto v1 = ctx.builder.CreateBitCast(rhs.value, t3);
+            auto v2 = ctx.builder.CreateAdd(v1, v0);
+            auto v3 = ctx.builder.CreateBitCast(v2, t2);
+            return {v3, rhs.type};
+          }
+          case OP_MINUS: {
+            auto t2 = rhs.type->llvm_type(loc, ctx);
+            auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
+            auto v0 = impl_convert(lhs.value, lhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
+            auto v1 = ctx.builder.CreateBitCast(rhs.value, t3);
+            auto v2 = ctx.builder.CreateSub(v1, v0);
+            auto v3 = ctx.builder.CreateBitCast(v2, t2);
+            return {v3, rhs.type};
+          }
+          default: break;
         }
         return nullval;
       case REFERENCE: {
-        auto t = static_cast<types::reference const*>(lhs.type)->base;
+        auto t = static_cast<types::reference const*>(rhs.type)->base;
         return binary_op(lhs, {ctx.builder.CreateLoad(t->llvm_type(loc, ctx), rhs.value), t}, op, loc, ctx);
       }
       case FUNCTION: return nullval;
       case NULLTYPE: return nullval;
-      case CUSTOM: return nullval;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullval;
     }
     case FLOAT: switch (rhs.type->kind) {
       case INTEGER:
-        if (op == "+") {
-          auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFAdd(lhs.value, v0);
-          return {v1, lhs.type};
-        }
-        if (op == "-") {
-          auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFSub(lhs.value, v0);
-          return {v1, lhs.type};
-        }
-        if (op == "*") {
-          auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFMul(lhs.value, v0);
-          return {v1, lhs.type};
-        }
-        if (op == "/") {
-          auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFDiv(lhs.value, v0);
-          return {v1, lhs.type};
-        }
-        if (op == "%") {
-          auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-          auto v1 = ctx.builder.CreateFRem(lhs.value, v0);
-          return {v1, lhs.type};
+        switch (op) {
+          case OP_PLUS: {
+            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFAdd(lhs.value, v0);
+            return {v1, lhs.type};
+          }
+          case OP_MINUS: {
+            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFSub(lhs.value, v0);
+            return {v1, lhs.type};
+          }
+          case OP_STAR: {
+            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFMul(lhs.value, v0);
+            return {v1, lhs.type};
+          }
+          case OP_SLASH: {
+            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFDiv(lhs.value, v0);
+            return {v1, lhs.type};
+          }
+          case OP_PERCENT: {
+            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+            auto v1 = ctx.builder.CreateFRem(lhs.value, v0);
+            return {v1, lhs.type};
+          }
+          default: break;
         }
         return nullval;
       case FLOAT:
-        if (op == "+") {
-          if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFAdd(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
-          else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFAdd(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
-          else return {ctx.builder.CreateFAdd(lhs.value, rhs.value), lhs.type};
-        }
-        if (op == "-") {
-          if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFSub(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
-          else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFSub(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
-          else return {ctx.builder.CreateFSub(lhs.value, rhs.value), lhs.type};
-        }
-        if (op == "*") {
-          if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFMul(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
-          else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFMul(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
-          else return {ctx.builder.CreateFMul(lhs.value, rhs.value), lhs.type};
-        }
-        if (op == "/") {
-          if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFDiv(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
-          else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFDiv(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
-          else return {ctx.builder.CreateFDiv(lhs.value, rhs.value), lhs.type};
-        }
-        if (op == "%") {
-          if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFRem(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
-          else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFRem(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
-          else return {ctx.builder.CreateFRem(lhs.value, rhs.value), lhs.type};
+        switch (op) {
+          case OP_PLUS: {
+            if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFAdd(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
+            else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFAdd(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
+            else return {ctx.builder.CreateFAdd(lhs.value, rhs.value), lhs.type};
+          }
+          case OP_MINUS: {
+            if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFSub(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
+            else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFSub(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
+            else return {ctx.builder.CreateFSub(lhs.value, rhs.value), lhs.type};
+          }
+          case OP_STAR: {
+            if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFMul(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
+            else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFMul(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
+            else return {ctx.builder.CreateFMul(lhs.value, rhs.value), lhs.type};
+          }
+          case OP_SLASH: {
+            if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFDiv(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
+            else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFDiv(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
+            else return {ctx.builder.CreateFDiv(lhs.value, rhs.value), lhs.type};
+          }
+          case OP_PERCENT: {
+            if (lhs.type->size() > rhs.type->size()) return {ctx.builder.CreateFRem(lhs.value, ctx.builder.CreateFPExt(rhs.value, lhs.type->llvm_type(loc, ctx))), lhs.type};
+            else if (lhs.type->size() < rhs.type->size()) return {ctx.builder.CreateFRem(ctx.builder.CreateFPExt(lhs.value, rhs.type->llvm_type(loc, ctx)), rhs.value), rhs.type};
+            else return {ctx.builder.CreateFRem(lhs.value, rhs.value), lhs.type};
+          }
+          default: break;
         }
         return nullval;
       case POINTER: return nullval;
       case REFERENCE: {
-        auto t = static_cast<types::reference const*>(lhs.type)->base;
+        auto t = static_cast<types::reference const*>(rhs.type)->base;
         return binary_op(lhs, {ctx.builder.CreateLoad(t->llvm_type(loc, ctx), rhs.value), t}, op, loc, ctx);
       }
       case FUNCTION: return nullval;
       case NULLTYPE: return nullval;
-      case CUSTOM: return nullval;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullval;
     }
     case POINTER: switch (rhs.type->kind) {
       case INTEGER:
-        if (op == "+") {
-          auto t2 = lhs.type->llvm_type(loc, ctx);
-          auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
-          auto v0 = impl_convert(rhs.value, rhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
-          auto v1 = ctx.builder.CreateBitCast(lhs.value, t3);
-          auto v2 = ctx.builder.CreateAdd(v1, v0);
-          auto v3 = ctx.builder.CreateBitCast(v2, t2);
-          return {v3, lhs.type};
-        }
-        if (op == "-") {
-          auto t2 = lhs.type->llvm_type(loc, ctx);
-          auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
-          auto v0 = impl_convert(rhs.value, rhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
-          auto v1 = ctx.builder.CreateBitCast(lhs.value, t3);
-          auto v2 = ctx.builder.CreateSub(v1, v0);
-          auto v3 = ctx.builder.CreateBitCast(v2, t2);
-          return {v3, lhs.type};
+        switch (op) {
+          case OP_PLUS: {
+            auto t2 = lhs.type->llvm_type(loc, ctx);
+            auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
+            auto v0 = impl_convert(rhs.value, rhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
+            auto v1 = ctx.builder.CreateBitCast(lhs.value, t3);
+            auto v2 = ctx.builder.CreateAdd(v1, v0);
+            auto v3 = ctx.builder.CreateBitCast(v2, t2);
+            return {v3, lhs.type};
+          }
+          case OP_MINUS: {
+            auto t2 = lhs.type->llvm_type(loc, ctx);
+            auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
+            auto v0 = impl_convert(rhs.value, rhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
+            auto v1 = ctx.builder.CreateBitCast(lhs.value, t3);
+            auto v2 = ctx.builder.CreateSub(v1, v0);
+            auto v3 = ctx.builder.CreateBitCast(v2, t2);
+            return {v3, lhs.type};
+          }
+          default: break;
         }
         return nullval;
       case FLOAT: return nullval;
       case POINTER:
-        if (op == "-") {
+        if (op == OP_MINUS) {
           auto t2 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
           auto v1 = ctx.builder.CreateBitCast(lhs.value, t2);
           auto v2 = ctx.builder.CreateBitCast(rhs.value, t2);
@@ -568,209 +715,299 @@ static typed_value binary_op(typed_value lhs, typed_value rhs, std::string_view
         }
         return nullval;
       case REFERENCE: {
-        auto t = static_cast<types::reference const*>(lhs.type)->base;
+        auto t = static_cast<types::reference const*>(rhs.type)->base;
         return binary_op(lhs, {ctx.builder.CreateLoad(t->llvm_type(loc, ctx), rhs.value), t}, op, loc, ctx);
       }
       case FUNCTION: return nullval;
       case NULLTYPE: return nullval;
-      case CUSTOM: return nullval;
+      case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullval;
     }
     case REFERENCE: {
       auto t = static_cast<types::reference const*>(lhs.type)->base;
       switch (t->kind) {
         case INTEGER:
-          if (op == "=") {
-            auto v = impl_convert(rhs.value, rhs.type, t, loc, ctx);
-            if (!v) return nullval;
-            return {ctx.builder.CreateStore(v, lhs.value), lhs.type};
-          }
-          if (op == "+=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateAdd(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "-=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateSub(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "*=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateMul(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "/=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto [_, s] = is_signed(lhs.type, rhs.type);
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = s ? ctx.builder.CreateSDiv(v1, llvm::ConstantInt::get(t2, 1)) : ctx.builder.CreateUDiv(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "%=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto [_, s] = is_signed(lhs.type, rhs.type);
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = s ? ctx.builder.CreateSRem(v1, llvm::ConstantInt::get(t2, 1)) : ctx.builder.CreateURem(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "&=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateAnd(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "|=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateOr(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "^=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateXor(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "<<=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateShl(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == ">>=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateLShr(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
+          switch (op) {
+            case OP_ASSIGN: {
+              auto v = impl_convert(rhs.value, rhs.type, t, loc, ctx);
+              if (!v) return nullval;
+              return {ctx.builder.CreateStore(v, lhs.value), lhs.type};
+            }
+            case OP_PLUS_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateAdd(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_MINUS_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateSub(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_STAR_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateMul(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_SLASH_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto [_, s] = is_signed(lhs.type, rhs.type);
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = s ? ctx.builder.CreateSDiv(v1, llvm::ConstantInt::get(t2, 1)) : ctx.builder.CreateUDiv(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_PERCENT_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto [_, s] = is_signed(lhs.type, rhs.type);
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = s ? ctx.builder.CreateSRem(v1, llvm::ConstantInt::get(t2, 1)) : ctx.builder.CreateURem(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_AMP_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateAnd(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_PIPE_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateOr(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_CARET_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateXor(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_SHL_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateShl(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_SHR_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateLShr(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            default: break;
           }
           break;
         case FLOAT:
-          if (op == "=") {
-            auto v = impl_convert(rhs.value, rhs.type, t, loc, ctx);
-            if (!v) return nullval;
-            return {ctx.builder.CreateStore(v, lhs.value), lhs.type};
-          }
-          if (op == "+=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateFAdd(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "-=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateFSub(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "*=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateFMul(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "/=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateFDiv(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
-          }
-          if (op == "%=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateFRem(v1, llvm::ConstantInt::get(t2, 1));
-            auto v3 = ctx.builder.CreateStore(v2, lhs.value);
-            return {v3, lhs.type};
+          switch (op) {
+            case OP_ASSIGN: {
+              auto v = impl_convert(rhs.value, rhs.type, t, loc, ctx);
+              if (!v) return nullval;
+              return {ctx.builder.CreateStore(v, lhs.value), lhs.type};
+            }
+            case OP_PLUS_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateFAdd(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_MINUS_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateFSub(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_STAR_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateFMul(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_SLASH_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateFDiv(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            case OP_PERCENT_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto v0 = impl_convert(rhs.value, rhs.type, lhs.type, loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateFRem(v1, llvm::ConstantInt::get(t2, 1));
+              auto v3 = ctx.builder.CreateStore(v2, lhs.value);
+              return {v3, lhs.type};
+            }
+            default: break;
           }
           break;
         case POINTER:
-          if (op == "=") {
-            auto v = impl_convert(rhs.value, rhs.type, t, loc, ctx);
-            if (!v) return nullval;
-            return {ctx.builder.CreateStore(v, lhs.value), lhs.type};
-          }
-          if (op == "+=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
-            auto v0 = impl_convert(rhs.value, rhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateBitCast(v1, t3);
-            auto v3 = ctx.builder.CreateAdd(v2, v0);
-            auto v4 = ctx.builder.CreateBitCast(v1, t2);
-            auto v5 = ctx.builder.CreateStore(v4, lhs.value);
-            return {v5, lhs.type};
-          }
-          if (op == "-=") {
-            auto t2 = t->llvm_type(loc, ctx);
-            auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
-            auto v0 = impl_convert(rhs.value, rhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
-            if (!v0) return nullval;
-            auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
-            auto v2 = ctx.builder.CreateBitCast(v1, t3);
-            auto v3 = ctx.builder.CreateSub(v2, v0);
-            auto v4 = ctx.builder.CreateBitCast(v1, t2);
-            auto v5 = ctx.builder.CreateStore(v4, lhs.value);
-            return {v5, lhs.type};
+          switch (op) {
+            case OP_ASSIGN: {
+              auto v = impl_convert(rhs.value, rhs.type, t, loc, ctx);
+              if (!v) return nullval;
+              return {ctx.builder.CreateStore(v, lhs.value), lhs.type};
+            }
+            case OP_PLUS_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
+              auto v0 = impl_convert(rhs.value, rhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateBitCast(v1, t3);
+              auto v3 = ctx.builder.CreateAdd(v2, v0);
+              auto v4 = ctx.builder.CreateBitCast(v1, t2);
+              auto v5 = ctx.builder.CreateStore(v4, lhs.value);
+              return {v5, lhs.type};
+            }
+            case OP_MINUS_ASSIGN: {
+              auto t2 = t->llvm_type(loc, ctx);
+              auto t3 = llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8);
+              auto v0 = impl_convert(rhs.value, rhs.type, types::integer::get(sizeof(void*) * 8), loc, ctx);
+              if (!v0) return nullval;
+              auto v1 = ctx.builder.CreateLoad(t2, lhs.value);
+              auto v2 = ctx.builder.CreateBitCast(v1, t3);
+              auto v3 = ctx.builder.CreateSub(v2, v0);
+              auto v4 = ctx.builder.CreateBitCast(v1, t2);
+              auto v5 = ctx.builder.CreateStore(v4, lhs.value);
+              return {v5, lhs.type};
+            }
+            default: break;
           }
           break;
         case REFERENCE: break;
         case FUNCTION: return nullval;
         case NULLTYPE: return nullval;
-        case CUSTOM: break;
+        case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: break;
       }
       return binary_op({ctx.builder.CreateLoad(t->llvm_type(loc, ctx), lhs.value), t}, rhs, op, loc, ctx);
     }
     case FUNCTION: return nullval;
     case NULLTYPE: return nullval;
-    case CUSTOM: return nullval;
+    case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM: return nullval;
+  }
+}
+static llvm::FunctionCallee get_malloc(compile_context& ctx) {return ctx.module->getOrInsertFunction("malloc", llvm::FunctionType::get(llvm::Type::getInt8PtrTy(*ctx.context), {llvm::Type::getInt64Ty(*ctx.context)}, false));}
+static llvm::FunctionCallee get_free(compile_context& ctx) {return ctx.module->getOrInsertFunction("free", llvm::FunctionType::get(llvm::Type::getVoidTy(*ctx.context), {llvm::Type::getInt8PtrTy(*ctx.context)}, false));}
+// a copy of v with its own heap memory, t has to own some
+static llvm::Value* copy_value(llvm::Value* v, type_ptr t, location loc, compile_context& ctx) {
+  if (t->kind == ARRAY) {
+    auto at = static_cast<types::array const*>(t);
+    for (unsigned i = 0; i < at->count; ++i) v = ctx.builder.CreateInsertValue(v, copy_value(ctx.builder.CreateExtractValue(v, {i}), at->elem, loc, ctx), {i});
+    return v;
+  }
+  auto st = static_cast<types::struct_ const*>(t);
+  for (auto const& f : st->fields) if (f.heat != types::struct_::COLD && owns_memory(f.type)) v = ctx.builder.CreateInsertValue(v, copy_value(ctx.builder.CreateExtractValue(v, {f.index}), f.type, loc, ctx), {f.index});
+  if (st->cold) {
+    auto ct = st->cold->llvm_type(loc, ctx);
+    llvm::Value* old = ctx.builder.CreateLoad(ct, ctx.builder.CreateExtractValue(v, {st->cold_index()}));
+    if (owns_memory(st->cold)) old = copy_value(old, st->cold, loc, ctx);
+    auto cold = ctx.builder.CreateBitCast(ctx.builder.CreateCall(get_malloc(ctx), {llvm::ConstantExpr::getSizeOf(ct)}), llvm::PointerType::get(ct, 0));
+    ctx.builder.CreateStore(old, cold);
+    v = ctx.builder.CreateInsertValue(v, cold, {st->cold_index()});
+  }
+  return v;
+}
+// free the heap memory that v owns, t has to own some
+static void free_value(llvm::Value* v, type_ptr t, location loc, compile_context& ctx) {
+  if (t->kind == REFERENCE) {
+    t = static_cast<types::reference const*>(t)->base;
+    v = ctx.builder.CreateLoad(t->llvm_type(loc, ctx), v);
+  }
+  if (t->kind == ARRAY) {
+    auto at = static_cast<types::array const*>(t);
+    for (unsigned i = 0; i < at->count; ++i) free_value(ctx.builder.CreateExtractValue(v, {i}), at->elem, loc, ctx);
+    return;
   }
+  auto st = static_cast<types::struct_ const*>(t);
+  for (auto const& f : st->fields) if (f.heat != types::struct_::COLD && owns_memory(f.type)) free_value(ctx.builder.CreateExtractValue(v, {f.index}), f.type, loc, ctx);
+  if (st->cold) {
+    auto ptr = ctx.builder.CreateExtractValue(v, {st->cold_index()});
+    if (owns_memory(st->cold)) free_value(ctx.builder.CreateLoad(st->cold->llvm_type(loc, ctx), ptr), st->cold, loc, ctx);
+    ctx.builder.CreateCall(get_free(ctx), {ctx.builder.CreateBitCast(ptr, llvm::Type::getInt8PtrTy(*ctx.context))});
+  }
+}
+// the value of tv for a new owner, temporaries are moved and anything else is copied
+static llvm::Value* take_value(typed_value tv, location loc, compile_context& ctx) {
+  if (tv.type->kind == REFERENCE) {
+    auto t = static_cast<types::reference const*>(tv.type)->base;
+    return copy_value(ctx.builder.CreateLoad(t->llvm_type(loc, ctx), tv.value), t, loc, ctx);
+  }
+  auto it = std::find_if(ctx.temps.begin(), ctx.temps.end(), [&] (typed_value const& t) {return t.value == tv.value;});
+  if (it == ctx.temps.end()) return copy_value(tv.value, tv.type, loc, ctx);
+  ctx.temps.erase(it);
+  return tv.value;
+}
+// free the temporaries made since mark, except for keep, which is left for whatever uses it
+static void free_temps(std::size_t mark, llvm::Value* keep, location loc, compile_context& ctx) {
+  std::optional<typed_value> kept;
+  for (auto i = ctx.temps.size(); i > mark; --i) {
+    if (keep && ctx.temps[i - 1].value == keep) kept = ctx.temps[i - 1];
+    else free_value(ctx.temps[i - 1].value, ctx.temps[i - 1].type, loc, ctx);
+  }
+  ctx.temps.resize(mark);
+  if (kept) ctx.temps.push_back(*kept);
+}
+// free what locals at depth or deeper own, newest first
+static void free_owned(std::size_t depth, location loc, compile_context& ctx) {
+  for (; !ctx.owned.empty() && ctx.owned.back().second >= depth; ctx.owned.pop_back()) free_value(ctx.owned.back().first.value, ctx.owned.back().first.type, loc, ctx);
+}
+// leave the innermost scope, freeing what its locals own
+// its value outlives it as a temporary, it's moved out of a local that owns it and copied otherwise
+static typed_value end_scope(typed_value tv, location loc, compile_context& ctx) {
+  auto t = tv.type && tv.type->kind == REFERENCE ? static_cast<types::reference const*>(tv.type)->base : tv.type;
+  if (t && owns_memory(t) && std::none_of(ctx.temps.begin(), ctx.temps.end(), [&] (typed_value const& x) {return x.value == tv.value;})) {
+    auto it = std::find_if(ctx.owned.begin(), ctx.owned.end(), [&] (auto const& o) {return o.first.value == tv.value && o.second >= ctx.locals.depth();});
+    if (it != ctx.owned.end()) {
+      ctx.owned.erase(it);
+      tv = {tv.type == t ? tv.value : ctx.builder.CreateLoad(t->llvm_type(loc, ctx), tv.value), t};
+    }
+    else tv = {take_value(tv, loc, ctx), t};
+    ctx.temps.push_back(tv);
+  }
+  free_owned(ctx.locals.depth(), loc, ctx);
+  return tv;
 }
 static std::string invalid_args(typed_value tv, std::vector<typed_value>&& args) {
   std::string str = "cannot call value of type ";
@@ -787,8 +1024,62 @@ static std::string invalid_args(typed_value tv, std::vector<typed_value>&& args)
   }
   return str;
 }
+// generate the instance of a generic function for a list of type arguments, or reuse it if it's already been generated
+static typed_value instantiate(types::generic const* g, std::vector<type_ptr>&& targs, location loc, compile_context& ctx) {
+  auto fn = g->def;
+  if (targs.size() != fn->tparams.size()) {
+    ctx.flags.onerror(loc, (llvm::Twine("generic function ") + fn->name + " expects " + llvm::Twine(fn->tparams.size()) + " type arguments, but " + llvm::Twine(targs.size()) + " were given").str(), ERROR);
+    return nullval;
+  }
+  compile_context::instance_key key{fn, std::move(targs)};
+  if (auto it = ctx.instances.find(key); it != ctx.instances.end()) return it->second;
+  auto sit = ctx.generics.find(fn);
+  if (sit == ctx.generics.end()) return nullval;
+  auto const& scope = sit->second;
+  // the body is generated in the scope of the definition, with the type parameters bound to the arguments
+  symbol_table locals;
+  if (!scope.local) std::swap(ctx.locals, locals);
+  auto old_vars = std::exchange(ctx.vars, scope.vars);
+  auto old_path = std::exchange(ctx.path, scope.path);
+  auto old_inst = std::exchange(ctx.instantiating, &key);
+  auto ip = ctx.builder.saveIP();
+  ctx.locals.push_scope();
+  for (std::size_t i = 0; i < fn->tparams.size(); ++i) ctx.locals.insert(fn->tparams[i], key.second[i]);
+  fn->codegen(ctx);
+  ctx.locals.pop_scope();
+  ctx.builder.restoreIP(ip);
+  ctx.instantiating = old_inst;
+  ctx.path = std::move(old_path);
+  ctx.vars = old_vars;
+  if (!scope.local) std::swap(ctx.locals, locals);
+  auto it = ctx.instances.find(key);
+  return it == ctx.instances.end() ? nullval : it->second;
+}
 static typed_value call(typed_value tv, std::vector<typed_value>&& args, location loc, compile_context& ctx) {
   if (!tv.type) return nullval;
+  if (auto g = types::generic::of(tv.type)) {
+    std::vector<type_ptr> args_t(args.size());
+    for (std::size_t i = 0; i < args.size(); ++i) if (!(args_t[i] = args[i].type)) return nullval;
+    auto targs = g->def->deduce(args_t);
+    if (targs.empty()) {
+      std::string str = "cannot deduce the type arguments of generic function ";
+      str += g->def->name;
+      str += " for argument types (";
+      for (auto t : args_t) {
+        str += t->name();
+        str += ", ";
+      }
+      if (args_t.empty()) str += ')';
+      else {
+        str.pop_back();
+        str.back() = ')';
+      }
+      ctx.flags.onerror(loc, str, ERROR);
+      return nullval;
+    }
+    tv = instantiate(g, std::move(targs), loc, ctx);
+    return call(tv, std::move(args), loc, ctx);
+  }
   switch (tv.type->kind) {
     case INTEGER:
     case FLOAT:
@@ -816,7 +1107,7 @@ static typed_value call(typed_value tv, std::vector<typed_value>&& args, locatio
     case NULLTYPE:
       ctx.flags.onerror(loc, invalid_args(tv, std::move(args)), ERROR);
       return nullval;
-    case CUSTOM:
+    case VECTOR: case ARRAY: case SLICE: case STRUCT: case SOA: case VARIANT: case ENUM: case CUSTOM:
       ctx.flags.onerror(loc, invalid_args(tv, std::move(args)), ERROR);
       return nullval;
   }
@@ -833,9 +1124,196 @@ static std::string concat(std::vector<std::string_view> const& vals, std::string
   out += other;
   return out;
 }
+// report why ctx.resolve failed for name
+static void unresolved(std::string_view name, std::size_t fail, location loc, compile_context& ctx) {
+  auto prefix = name.substr(0, fail);
+  if (fail != name.size() && ctx.resolve(prefix)) ctx.flags.onerror(loc, (llvm::Twine(prefix) + " is not a module").str(), ERROR);
+  else ctx.flags.onerror(loc, (llvm::Twine(prefix) + " does not exist").str(), ERROR);
+}
+// undotted names are defined in the innermost scope, dotted ones in the module they name
+static bool define(varmap* vm, std::string_view local, symbol_type sym, compile_context& ctx) {return vm == ctx.vars ? ctx.define(sstring::get(local), std::move(sym)) : vm->insert(sstring::get(local), std::move(sym));}
+// structs with hot fields are over-aligned, and LLVM types don't carry that, so it's set on the storage
+template <class T> static void set_align(T* val, type_ptr t) {if (t->kind == STRUCT) val->setAlignment(llvm::Align(t->align()));}
+// find or create the module named by the first count segments of path, returns null after reporting an error if one of them isn't a module
+static varmap* def_module(qpath const& path, std::size_t count, location loc, compile_context& ctx) {
+  varmap* vm = ctx.vars;
+  if (path.absolute) while (vm->parent) vm = vm->parent;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto it = vm->symbols.find(path.segments[i]);
+    auto sym = it == vm->symbols.end() ? vm->emplace(path.segments[i], std::make_shared<varmap>(vm)).first : &it->second;
+    if (sym->index() != 2) {
+      ctx.flags.onerror(loc, (llvm::Twine(path.name.substr(0, path.prefix_size(i + 1))) + " is not a module").str(), ERROR);
+      return nullptr;
+    }
+    vm = std::get<2>(*sym).get();
+  }
+  return vm;
+}
+// access a field of a struct or a reference to one, fields of references are references too
+static typed_value get_field(typed_value tv, sstring name, location loc, compile_context& ctx) {
+  bool is_ref = tv.type->kind == REFERENCE;
+  auto t = is_ref ? static_cast<types::reference const*>(tv.type)->base : tv.type;
+  if (t->kind == ARRAY || t->kind == SLICE) {
+    // arrays only have their length, and slices their length and pointer, neither can be assigned to
+    auto ft = types::sequence_field(t, name);
+    if (!ft) {
+      ctx.flags.onerror(loc, (llvm::Twine(t->name()) + " has no field '" + name + "'").str(), ERROR);
+      return nullval;
+    }
+    if (t->kind == ARRAY) return {llvm::ConstantInt::get(ft->llvm_type(loc, ctx), static_cast<types::array const*>(t)->count), ft};
+    auto v = is_ref ? ctx.builder.CreateLoad(t->llvm_type(loc, ctx), tv.value) : tv.value;
+    return {ctx.builder.CreateExtractValue(v, {name == "len" ? 1u : 0u}), ft};
+  }
+  if (t->kind != STRUCT) {
+    ctx.flags.onerror(loc, (llvm::Twine("value of type ") + tv.type->name() + " does not have fields").str(), ERROR);
+    return nullval;
+  }
+  auto st = static_cast<types::struct_ const*>(t);
+  auto f = st->get_field(name);
+  if (!f) {
+    ctx.flags.onerror(loc, (llvm::Twine(t->name()) + " has no field '" + name + "'").str(), ERROR);
+    return nullval;
+  }
+  if (f->heat == types::struct_::COLD) {
+    // cold fields are behind the pointer at the end, but that's hidden from the source
+    auto ct = st->cold->llvm_type(loc, ctx);
+    llvm::Value* ptr;
+    if (is_ref) ptr = ctx.builder.CreateLoad(llvm::PointerType::get(ct, 0), ctx.builder.CreateStructGEP(st->llvm_type(loc, ctx), tv.value, st->cold_index()));
+    else ptr = ctx.builder.CreateExtractValue(tv.value, {st->cold_index()});
+    auto gep = ctx.builder.CreateStructGEP(ct, ptr, f->index);
+    if (is_ref) return {gep, types::reference::get(f->type)};
+    return {ctx.builder.CreateLoad(f->type->llvm_type(loc, ctx), gep), f->type};
+  }
+  if (is_ref) return {ctx.builder.CreateStructGEP(st->llvm_type(loc, ctx), tv.value, f->index), types::reference::get(f->type)};
+  return {ctx.builder.CreateExtractValue(tv.value, {f->index}), f->type};
+}
+// evaluate an index for a subscript, as an i64
+static llvm::Value* get_index(AST const& ast, location loc, compile_context& ctx) {
+  auto tv = ast(ctx);
+  if (!tv.type) return nullptr;
+  auto v = impl_convert(tv.value, tv.type, types::integer::get(64), loc, ctx);
+  if (!v) ctx.flags.onerror(loc, (llvm::Twine("cannot use value of type ") + tv.type->name() + " as an index").str(), ERROR);
+  return v;
+}
+// trap unless i < len, the comparison is marked so that elide_bounds_checks can remove it if it always passes
+static bool bounds_check(llvm::Value* i, llvm::Value* len, location loc, compile_context& ctx) {
+  auto ci = llvm::dyn_cast<llvm::ConstantInt>(i), cl = llvm::dyn_cast<llvm::ConstantInt>(len);
+  if (ci && cl) {
+    if (ci->getValue().ult(cl->getValue())) return true;
+    ctx.flags.onerror(loc, (llvm::Twine("index ") + llvm::Twine(ci->getSExtValue()) + " is out of bounds for length " + llvm::Twine(cl->getZExtValue())).str(), ERROR);
+    return false;
+  }
+  if (!ctx.flags.bounds_checks) return true;
+  auto f = ctx.builder.GetInsertBlock()->getParent();
+  auto in_bounds = llvm::BasicBlock::Create(*ctx.context, "in_bounds", f), out_of_bounds = llvm::BasicBlock::Create(*ctx.context, "out_of_bounds", f);
+  auto cmp = llvm::cast<llvm::Instruction>(ctx.builder.CreateICmpULT(i, len));
+  cmp->setMetadata(bounds_check_md, llvm::MDNode::get(*ctx.context, {}));
+  ctx.builder.CreateCondBr(cmp, in_bounds, out_of_bounds);
+  ctx.builder.SetInsertPoint(out_of_bounds);
+  ctx.builder.CreateCall(llvm::Intrinsic::getDeclaration(ctx.module.get(), llvm::Intrinsic::trap));
+  ctx.builder.CreateUnreachable();
+  ctx.builder.SetInsertPoint(in_bounds);
+  return true;
+}
+// the address of a field of an element of a structure of arrays, only that field's column is touched
+static typed_value soa_field(typed_value xs, llvm::Value* i, sstring name, location loc, compile_context& ctx) {
+  auto t = types::soa::of(xs.type);
+  auto f = t->elem->get_field(name);
+  if (!f) {
+    ctx.flags.onerror(loc, (llvm::Twine(t->elem->name()) + " has no field '" + name + "'").str(), ERROR);
+    return nullval;
+  }
+  auto ft = f->type->llvm_type(loc, ctx);
+  llvm::Value* col;
+  if (xs.type->kind == REFERENCE) col = ctx.builder.CreateLoad(llvm::PointerType::get(ft, 0), ctx.builder.CreateStructGEP(t->llvm_type(loc, ctx), xs.value, t->column(f)));
+  else col = ctx.builder.CreateExtractValue(xs.value, {t->column(f)});
+  return {ctx.builder.CreateGEP(ft, col, i), types::reference::get(f->type)};
+}
+// generate the body of f in the current scope, the insert point is restored afterwards
+static void define_body(ast::fndef_ast const& fn, llvm::Function* f, type_ptr t, std::vector<type_ptr> const& args_t, compile_context& ctx) {
+  std::vector<std::string_view> old_path;
+  if (fn.name.front() == '.') {
+    old_path = ctx.path;
+    ctx.path = {fn.name.substr(1)};
+  }
+  else ctx.path.push_back(fn.name);
+  auto bb = llvm::BasicBlock::Create(*ctx.context, "entry", f);
+  auto ip = ctx.builder.GetInsertBlock();
+  ctx.builder.SetInsertPoint(bb);
+  ctx.locals.push_scope();
+  // arguments are borrowed from the caller, so they aren't owned here
+  decltype(ctx.owned) owned;
+  decltype(ctx.temps) temps;
+  std::swap(ctx.owned, owned);
+  std::swap(ctx.temps, temps);
+  for (std::size_t i = 0; i < fn.args.size(); ++i) if (!fn.args[i].first.empty()) ctx.locals.insert(fn.args[i].first, typed_value{f->getArg(i), args_t[i]});
+  auto tv = fn.get_body()(ctx);
+  llvm::Value* ret = nullptr;
+  if (t->kind != NULLTYPE && tv.type) {
+    // the caller owns the return value, so it's moved or copied out before anything here is freed
+    if (owns_memory(t) && (tv.type == t || tv.type == types::reference::get(t))) tv = {take_value(tv, fn.loc, ctx), t};
+    ret = impl_convert(tv.value, tv.type, t, fn.loc, ctx);
+  }
+  free_temps(0, nullptr, fn.loc, ctx);
+  free_owned(0, fn.loc, ctx);
+  std::swap(ctx.owned, owned);
+  std::swap(ctx.temps, temps);
+  if (t->kind != NULLTYPE) ctx.builder.CreateRet(ret ? ret : llvm::Constant::getNullValue(t->llvm_type(fn.loc, ctx)));
+  else ctx.builder.CreateRetVoid();
+  ctx.locals.pop_scope();
+  if (ctx.flags.bounds_checks) elide_bounds_checks(*f);
+  ctx.builder.SetInsertPoint(ip);
+  if (fn.name.front() == '.') std::swap(ctx.path, old_path);
+  else ctx.path.pop_back();
+}
+// add the deferred functions that val references to work, constants are searched through but other globals aren't
+static void find_deferred(llvm::Value const* val, compile_context& ctx, std::vector<llvm::Function const*>& work) {
+  if (auto f = llvm::dyn_cast<llvm::Function>(val)) {
+    if (ctx.deferred.contains(f)) work.push_back(f);
+  }
+  else if (llvm::isa<llvm::Constant>(val) && !llvm::isa<llvm::GlobalValue>(val)) for (auto const& op : llvm::cast<llvm::User>(val)->operands()) find_deferred(op, ctx, work);
+}
+static void find_deferred(llvm::Function const& f, compile_context& ctx, std::vector<llvm::Function const*>& work) {
+  for (auto const& bb : f) for (auto const& inst : bb) for (auto const& op : inst.operands()) find_deferred(op, ctx, work);
+}
+// generate the deferred functions in work, and the ones that their bodies reference in turn
+// the rest are left as declarations, so that their symbols stay valid
+static void define_reachable(std::vector<llvm::Function const*> work, compile_context& ctx) {
+  while (!work.empty()) {
+    auto node = ctx.deferred.extract(work.back());
+    work.pop_back();
+    if (node.empty()) continue; // already generated, a function can be referenced more than once
+    auto& d = node.mapped();
+    symbol_table locals;
+    std::swap(ctx.locals, locals);
+    auto old_vars = std::exchange(ctx.vars, d.scope.vars);
+    auto old_path = std::exchange(ctx.path, d.scope.path);
+    auto old_visible = std::exchange(ctx.visible, d.visible);
+    auto ip = ctx.builder.saveIP();
+    auto ft = static_cast<types::function const*>(d.type);
+    define_body(*d.def, d.fn, ft->ret, ft->args, ctx);
+    ctx.builder.restoreIP(ip);
+    ctx.visible = old_visible;
+    ctx.path = std::move(old_path);
+    ctx.vars = old_vars;
+    std::swap(ctx.locals, locals);
+    find_deferred(*d.fn, ctx, work);
+  }
+}
+// generate the deferred functions that f references, so that it can be run at compile time
+static void define_reachable(llvm::Function const& f, compile_context& ctx) {
+  if (ctx.deferred.empty()) return;
+  std::vector<llvm::Function const*> work;
+  find_deferred(f, ctx, work);
+  define_reachable(std::move(work), ctx);
+}
 // flow.hpp
 typed_value cobalt::ast::top_level_ast::codegen(compile_context& ctx) const {
   for (auto const& ast : insts) ast(ctx);
+  // function bodies are handled as they're generated, this is for anything else that references a deferred function
+  std::vector<llvm::Function const*> work;
+  for (auto const& [f, _] : ctx.deferred) if (!f->use_empty()) work.push_back(f);
+  define_reachable(std::move(work), ctx);
   return nullval;
 }
 typed_value cobalt::ast::group_ast::codegen(compile_context& ctx) const {
@@ -844,12 +1322,16 @@ typed_value cobalt::ast::group_ast::codegen(compile_context& ctx) const {
   return last;
 }
 typed_value cobalt::ast::block_ast::codegen(compile_context& ctx) const {
-  ctx.vars = new varmap(ctx.vars);
+  ctx.locals.push_scope();
   typed_value last {};
-  for (auto const& ast : insts) last = ast(ctx);
-  auto vars = ctx.vars;
-  ctx.vars = ctx.vars->parent;
-  delete vars;
+  for (std::size_t i = 0; i < insts.size(); ++i) {
+    auto mark = ctx.temps.size();
+    last = insts[i](ctx);
+    // temporaries die at the end of their statement, except for the block's value
+    free_temps(mark, i + 1 == insts.size() ? last.value : nullptr, loc, ctx);
+  }
+  last = end_scope(last, loc, ctx);
+  ctx.locals.pop_scope();
   return last;
 }
 typed_value cobalt::ast::if_ast::codegen(compile_context& ctx) const {(void)ctx; return nullval;}
@@ -857,7 +1339,7 @@ typed_value cobalt::ast::while_ast::codegen(compile_context& ctx) const {(void)c
 typed_value cobalt::ast::for_ast::codegen(compile_context& ctx) const {(void)ctx; return nullval;}
 // funcs.hpp
 typed_value cobalt::ast::cast_ast::codegen(compile_context& ctx) const {
-  auto t = parse_type(target);
+  auto t = ctx.parse_type(target);
   if (!t) {
     ctx.flags.onerror(loc, (llvm::Twine("invalid type name '") + target + "' in cast").str(), ERROR);
     return nullval;
@@ -871,7 +1353,7 @@ typed_value cobalt::ast::cast_ast::codegen(compile_context& ctx) const {
   return {v, t};
 }
 typed_value cobalt::ast::binop_ast::codegen(compile_context& ctx) const {
-  if (std::string_view(op) == "&&") {
+  if (op == OP_LAND) {
     auto l = lhs(ctx);
     if (!l.type) return nullval;
     auto f = ctx.builder.GetInsertBlock()->getParent();
@@ -882,12 +1364,14 @@ typed_value cobalt::ast::binop_ast::codegen(compile_context& ctx) const {
     auto v = expl_convert(l.value, l.type, types::integer::get(1), loc, ctx);
     ctx.builder.CreateCondBr(v, if_true, if_false);
     ctx.builder.SetInsertPoint(if_true);
+    auto mark = ctx.temps.size();
     auto itv = rhs(ctx);
     while (itv.type->kind == REFERENCE) {
       auto t = static_cast<types::reference const*>(itv.type)->base;
       itv.value = ctx.builder.CreateLoad(t->llvm_type(loc, ctx), itv.value);
       itv.type = t;
     }
+    free_temps(mark, itv.value, loc, ctx); // temporaries from the right side only exist on this path
     auto llt = itv.type->llvm_type(loc, ctx);
     ctx.builder.CreateBr(merge);
     if_true = ctx.builder.GetInsertBlock();
@@ -901,9 +1385,10 @@ typed_value cobalt::ast::binop_ast::codegen(compile_context& ctx) const {
     auto pn = ctx.builder.CreatePHI(llt, 2);
     pn->addIncoming(itv.value, if_true);
     pn->addIncoming(ifv, if_false);
+    if (ctx.temps.size() > mark) ctx.temps.back() = {pn, itv.type};
     return {pn, itv.type};
   }
-  if (std::string_view(op) == "||") {
+  if (op == OP_LOR) {
     auto l = lhs(ctx);
     if (!l.type) return nullval;
     auto f = ctx.builder.GetInsertBlock()->getParent();
@@ -914,12 +1399,14 @@ typed_value cobalt::ast::binop_ast::codegen(compile_context& ctx) const {
     auto v = expl_convert(l.value, l.type, types::integer::get(1), loc, ctx);
     ctx.builder.CreateCondBr(v, if_true, if_false);
     ctx.builder.SetInsertPoint(if_false);
+    auto mark = ctx.temps.size();
     auto ifv = rhs(ctx);
     while (ifv.type->kind == REFERENCE) {
       auto t = static_cast<types::reference const*>(ifv.type)->base;
       ifv.value = ctx.builder.CreateLoad(t->llvm_type(loc, ctx), ifv.value);
       ifv.type = t;
     }
+    free_temps(mark, ifv.value, loc, ctx);
     auto llt = ifv.type->llvm_type(loc, ctx);
     ctx.builder.CreateBr(merge);
     if_false = ctx.builder.GetInsertBlock();
@@ -933,16 +1420,17 @@ typed_value cobalt::ast::binop_ast::codegen(compile_context& ctx) const {
     auto pn = ctx.builder.CreatePHI(llt, 2);
     pn->addIncoming(itv, if_true);
     pn->addIncoming(ifv.value, if_false);
+    if (ctx.temps.size() > mark) ctx.temps.back() = {pn, ifv.type};
     return {pn, ifv.type};
   }
   auto ltv = lhs(ctx), rtv = rhs(ctx);
   auto tv = binary_op(ltv, rtv, op, loc, ctx);
   if (tv.value && tv.type) return tv;
   switch ((int(bool(ltv.type)) << 1) | int(bool(rtv.type))) {
-    case 0: ctx.flags.onerror(loc, (llvm::Twine("invalid operator ") + op + " for values of types <error> and <error>").str(), ERROR); break;
-    case 1: ctx.flags.onerror(loc, (llvm::Twine("invalid operator ") + op + " for values of types <error> and '" + rtv.type->name() + "'").str(), ERROR); break;
-    case 2: ctx.flags.onerror(loc, (llvm::Twine("invalid operator ") + op + " for values of types '" + ltv.type->name() + "' and <error>").str(), ERROR); break;
-    case 3: ctx.flags.onerror(loc, (llvm::Twine("invlaid operator ") + op + " for values of types '" + ltv.type->name() + "' and '" + rtv.type->name() + "'").str(), ERROR); break;
+    case 0: ctx.flags.onerror(loc, (llvm::Twine("invalid operator ") + op_name(op) + " for values of types <error> and <error>").str(), ERROR); break;
+    case 1: ctx.flags.onerror(loc, (llvm::Twine("invalid operator ") + op_name(op) + " for values of types <error> and '" + rtv.type->name() + "'").str(), ERROR); break;
+    case 2: ctx.flags.onerror(loc, (llvm::Twine("invalid operator ") + op_name(op) + " for values of types '" + ltv.type->name() + "' and <error>").str(), ERROR); break;
+    case 3: ctx.flags.onerror(loc, (llvm::Twine("invalid operator ") + op_name(op) + " for values of types '" + ltv.type->name() + "' and '" + rtv.type->name() + "'").str(), ERROR); break;
   }
   return nullval;
 }
@@ -951,29 +1439,254 @@ typed_value cobalt::ast::unop_ast::codegen(compile_context& ctx) const {
   auto v2 = unary_op(tv, op, loc, ctx);
   if (v2.value && v2.type) return v2;
   if (tv.type) {
-    if (op.front() == 'p') ctx.flags.onerror(loc, (llvm::Twine("invalid postfix operator ") + op.substr(1) + " for value of type '" + tv.type->name() + "'").str(), ERROR);
-    else ctx.flags.onerror(loc, (llvm::Twine("invalid prefix operator ") + op + " for value of type '" + tv.type->name() + "'").str(), ERROR);
+    if (is_postfix(op)) ctx.flags.onerror(loc, (llvm::Twine("invalid postfix operator ") + op_name(op).substr(1) + " for value of type '" + tv.type->name() + "'").str(), ERROR);
+    else ctx.flags.onerror(loc, (llvm::Twine("invalid prefix operator ") + op_name(op) + " for value of type '" + tv.type->name() + "'").str(), ERROR);
   }
   else {
-    if (op.front() == 'p') ctx.flags.onerror(loc, (llvm::Twine("invalid postfix operator ") + op.substr(1) + " for value of type <error>").str(), ERROR);
-    else ctx.flags.onerror(loc, (llvm::Twine("invalid prefix operator ") + op + " for value of type <error>").str(), ERROR);
+    if (is_postfix(op)) ctx.flags.onerror(loc, (llvm::Twine("invalid postfix operator ") + op_name(op).substr(1) + " for value of type <error>").str(), ERROR);
+    else ctx.flags.onerror(loc, (llvm::Twine("invalid prefix operator ") + op_name(op) + " for value of type <error>").str(), ERROR);
   }
   return nullval;
 }
-typed_value cobalt::ast::subscr_ast::codegen(compile_context& ctx) const {(void)ctx; return nullval;}
+typed_value cobalt::ast::subscr_ast::codegen(compile_context& ctx) const {
+  auto self = val(ctx);
+  if (!self.type) return nullval;
+  if (auto g = types::generic::of(self.type)) {
+    auto targs = type_args(ctx);
+    if (targs.empty()) {
+      ctx.flags.onerror(loc, (llvm::Twine("type arguments of generic function ") + g->def->name + " must be type names").str(), ERROR);
+      return nullval;
+    }
+    return instantiate(g, std::move(targs), loc, ctx);
+  }
+  if (auto t = types::vector::of(self.type); t && !args.empty()) {
+    if (self.type->kind == REFERENCE) self = {ctx.builder.CreateLoad(t->llvm_type(loc, ctx), self.value), t};
+    if (args.size() == 1) {
+      auto i = get_index(args.front(), loc, ctx);
+      return i ? typed_value{ctx.builder.CreateExtractElement(self.value, i), t->elem} : nullval;
+    }
+    // several indices shuffle the elements into a new vector, so they have to be known at compile time
+    std::vector<int> mask;
+    mask.reserve(args.size());
+    for (auto const& arg : args) {
+      auto i = get_index(arg, loc, ctx);
+      if (!i) return nullval;
+      auto c = llvm::dyn_cast<llvm::ConstantInt>(i);
+      if (!c || c->getZExtValue() >= t->count) {
+        ctx.flags.onerror(loc, (llvm::Twine("shuffle indices for ") + t->name() + " must be constants less than " + llvm::Twine(t->count)).str(), ERROR);
+        return nullval;
+      }
+      mask.push_back(c->getZExtValue());
+    }
+    return {ctx.builder.CreateShuffleVector(self.value, mask), types::vector::get(t->elem, args.size())};
+  }
+  if (args.size() != 1) {
+    ctx.flags.onerror(loc, (llvm::Twine("subscript of value of type ") + self.type->name() + " expects one index").str(), ERROR);
+    return nullval;
+  }
+  if (auto t = self.type->kind == REFERENCE ? static_cast<types::reference const*>(self.type)->base : self.type; t->kind == ARRAY || t->kind == SLICE) {
+    auto i = get_index(args.front(), loc, ctx);
+    if (!i) return nullval;
+    auto i64 = llvm::Type::getInt64Ty(*ctx.context);
+    if (t->kind == SLICE) {
+      auto elem = static_cast<types::slice const*>(t)->elem;
+      auto v = self.type->kind == REFERENCE ? ctx.builder.CreateLoad(t->llvm_type(loc, ctx), self.value) : self.value;
+      if (!bounds_check(i, ctx.builder.CreateExtractValue(v, {1}), loc, ctx)) return nullval;
+      return {ctx.builder.CreateInBoundsGEP(elem->llvm_type(loc, ctx), ctx.builder.CreateExtractValue(v, {0}), i), types::reference::get(elem)};
+    }
+    auto at = static_cast<types::array const*>(t);
+    auto lt = at->llvm_type(loc, ctx);
+    auto ptr = self.value;
+    if (auto c = llvm::dyn_cast<llvm::ConstantInt>(i); c && self.type->kind != REFERENCE) {
+      if (!bounds_check(c, llvm::ConstantInt::get(i64, at->count), loc, ctx)) return nullval;
+      return {ctx.builder.CreateExtractValue(self.value, {(unsigned)c->getZExtValue()}), at->elem};
+    }
+    if (self.type->kind != REFERENCE) {
+      // a dynamic index into an array value needs it in memory
+      auto& entry = ctx.builder.GetInsertBlock()->getParent()->getEntryBlock();
+      ptr = llvm::IRBuilder<>(&entry, entry.begin()).CreateAlloca(lt);
+      ctx.builder.CreateStore(self.value, ptr);
+    }
+    if (!bounds_check(i, llvm::ConstantInt::get(i64, at->count), loc, ctx)) return nullval;
+    return {ctx.builder.CreateInBoundsGEP(lt, ptr, {llvm::ConstantInt::get(i64, 0), i}), types::reference::get(at->elem)};
+  }
+  if (auto t = types::soa::of(self.type)) {
+    // the whole element is gathered from every column
+    if (t->elem->cold) {
+      ctx.flags.onerror(loc, (llvm::Twine("elements of ") + t->name() + " can only be accessed by field, since " + t->elem->name() + " has cold fields").str(), ERROR);
+      return nullval;
+    }
+    auto i = get_index(args.front(), loc, ctx);
+    if (!i) return nullval;
+    llvm::Value* out = llvm::UndefValue::get(t->elem->llvm_type(loc, ctx));
+    for (auto const& f : t->elem->fields) {
+      auto ref = soa_field(self, i, f.name, loc, ctx);
+      if (!ref.type) return nullval;
+      out = ctx.builder.CreateInsertValue(out, ctx.builder.CreateLoad(f.type->llvm_type(loc, ctx), ref.value), {f.index});
+    }
+    return {out, t->elem};
+  }
+  if (self.type->kind == REFERENCE) {
+    auto b = static_cast<types::reference const*>(self.type)->base;
+    self = {ctx.builder.CreateLoad(b->llvm_type(loc, ctx), self.value), b};
+  }
+  if (self.type->kind != POINTER) {
+    ctx.flags.onerror(loc, (llvm::Twine("value of type ") + self.type->name() + " cannot be subscripted").str(), ERROR);
+    return nullval;
+  }
+  auto i = get_index(args.front(), loc, ctx);
+  if (!i) return nullval;
+  auto b = static_cast<types::pointer const*>(self.type)->base;
+  return {ctx.builder.CreateGEP(b->llvm_type(loc, ctx), self.value, i), types::reference::get(b)};
+}
+typed_value cobalt::ast::member_ast::codegen(compile_context& ctx) const {
+  if (auto n = val.dyn_cast<subscr_ast>(); n && n->args.size() == 1) if (auto t = n->val.type(ctx); t && types::soa::of(t)) {
+    auto xs = n->val(ctx);
+    if (!xs.type) return nullval;
+    auto i = get_index(n->args.front(), loc, ctx);
+    return i ? soa_field(xs, i, field, loc, ctx) : nullval;
+  }
+  auto tv = val(ctx);
+  return tv.type ? get_field(tv, field, loc, ctx) : nullval;
+}
 typed_value cobalt::ast::call_ast::codegen(compile_context& ctx) const {
+  if (auto t = construct_type(ctx)) {
+    if (t->kind == SOA) {
+      // soa[T](n) allocates n elements in each column
+      if (args.size() != 1) {
+        ctx.flags.onerror(loc, (llvm::Twine(t->name()) + " is constructed from a number of elements, but " + llvm::Twine(args.size()) + " arguments were given").str(), ERROR);
+        return nullval;
+      }
+      auto xs = static_cast<types::soa const*>(t);
+      auto n = get_index(args.front(), loc, ctx);
+      if (!n) return nullval;
+      llvm::Value* out = llvm::UndefValue::get(t->llvm_type(loc, ctx));
+      for (auto const& f : xs->elem->fields) {
+        auto ft = f.type->llvm_type(loc, ctx);
+        auto col = ctx.builder.CreateCall(get_malloc(ctx), {ctx.builder.CreateMul(n, llvm::ConstantExpr::getSizeOf(ft))});
+        out = ctx.builder.CreateInsertValue(out, ctx.builder.CreateBitCast(col, llvm::PointerType::get(ft, 0)), {xs->column(&f)});
+      }
+      return {ctx.builder.CreateInsertValue(out, n, {(unsigned)xs->elem->fields.size()}), t};
+    }
+    if (t->kind == ARRAY) {
+      auto at = static_cast<types::array const*>(t);
+      if (args.size() != at->count) {
+        ctx.flags.onerror(loc, (llvm::Twine(t->name()) + " has " + llvm::Twine(at->count) + " elements, but " + llvm::Twine(args.size()) + " arguments were given").str(), ERROR);
+        return nullval;
+      }
+      llvm::Value* out = llvm::UndefValue::get(t->llvm_type(loc, ctx));
+      for (unsigned i = 0; i < args.size(); ++i) {
+        auto arg = args[i](ctx);
+        if (!arg.type) return nullval;
+        auto v = impl_convert(arg.value, arg.type, at->elem, loc, ctx);
+        if (!v) {
+          ctx.flags.onerror(loc, (llvm::Twine("cannot convert value of type ") + arg.type->name() + " to " + at->elem->name() + " for element " + llvm::Twine(i)).str(), ERROR);
+          return nullval;
+        }
+        if (owns_memory(at->elem)) v = take_value({v, at->elem}, loc, ctx);
+        out = ctx.builder.CreateInsertValue(out, v, {i});
+      }
+      if (owns_memory(t)) ctx.temps.push_back({out, t});
+      return {out, t};
+    }
+    if (t->kind == SLICE) {
+      // T[](ptr, len)
+      auto elem = static_cast<types::slice const*>(t)->elem;
+      if (args.size() != 2) {
+        ctx.flags.onerror(loc, (llvm::Twine(t->name()) + " is constructed from a pointer and a length, but " + llvm::Twine(args.size()) + " arguments were given").str(), ERROR);
+        return nullval;
+      }
+      auto p = args[0](ctx);
+      if (!p.type) return nullval;
+      auto ptr = impl_convert(p.value, p.type, types::pointer::get(elem), loc, ctx);
+      if (!ptr) {
+        ctx.flags.onerror(loc, (llvm::Twine("cannot convert value of type ") + p.type->name() + " to " + elem->name() + "*").str(), ERROR);
+        return nullval;
+      }
+      auto len = get_index(args[1], loc, ctx);
+      if (!len) return nullval;
+      return {ctx.builder.CreateInsertValue(ctx.builder.CreateInsertValue(llvm::UndefValue::get(t->llvm_type(loc, ctx)), ptr, {0}), len, {1}), t};
+    }
+    if (t->kind == VECTOR) {
+      // vectors are built from every element, or from one value that's splatted or converted
+      auto vt = static_cast<types::vector const*>(t);
+      if (args.size() == 1) {
+        auto arg = args.front()(ctx);
+        if (!arg.type) return nullval;
+        auto v = expl_convert(arg.value, arg.type, t, loc, ctx);
+        if (!v) ctx.flags.onerror(loc, (llvm::Twine("cannot convert value of type ") + arg.type->name() + " to " + t->name()).str(), ERROR);
+        return v ? typed_value{v, t} : nullval;
+      }
+      if (args.size() != vt->count) {
+        ctx.flags.onerror(loc, (llvm::Twine(t->name()) + " has " + llvm::Twine(vt->count) + " elements, but " + llvm::Twine(args.size()) + " arguments were given").str(), ERROR);
+        return nullval;
+      }
+      llvm::Value* out = llvm::UndefValue::get(t->llvm_type(loc, ctx));
+      for (std::size_t i = 0; i < args.size(); ++i) {
+        auto arg = args[i](ctx);
+        if (!arg.type) return nullval;
+        auto v = impl_convert(arg.value, arg.type, vt->elem, loc, ctx);
+        if (!v) {
+          ctx.flags.onerror(loc, (llvm::Twine("cannot convert value of type ") + arg.type->name() + " to " + vt->elem->name() + " for element " + llvm::Twine(i)).str(), ERROR);
+          return nullval;
+        }
+        out = ctx.builder.CreateInsertElement(out, v, i);
+      }
+      return {out, t};
+    }
+    if (t->kind != STRUCT) {
+      ctx.flags.onerror(loc, (llvm::Twine("type ") + t->name() + " cannot be constructed").str(), ERROR);
+      return nullval;
+    }
+    auto st = static_cast<types::struct_ const*>(t);
+    if (args.size() != st->fields.size()) {
+      ctx.flags.onerror(loc, (llvm::Twine(t->name()) + " has " + llvm::Twine(st->fields.size()) + " fields, but " + llvm::Twine(args.size()) + " arguments were given").str(), ERROR);
+      return nullval;
+    }
+    llvm::Value* out = llvm::UndefValue::get(t->llvm_type(loc, ctx));
+    llvm::Value* cold = nullptr;
+    if (st->cold) {
+      // cold fields get their own heap allocation, which this value owns
+      auto ct = st->cold->llvm_type(loc, ctx);
+      cold = ctx.builder.CreateBitCast(ctx.builder.CreateCall(get_malloc(ctx), {llvm::ConstantExpr::getSizeOf(ct)}), llvm::PointerType::get(ct, 0));
+      out = ctx.builder.CreateInsertValue(out, cold, {st->cold_index()});
+    }
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      auto const& f = st->fields[i];
+      auto arg = args[i](ctx);
+      if (!arg.type) return nullval;
+      auto v = impl_convert(arg.value, arg.type, f.type, loc, ctx);
+      if (!v) {
+        ctx.flags.onerror(loc, (llvm::Twine("cannot convert value of type ") + arg.type->name() + " to " + f.type->name() + " for field '" + f.name + "'").str(), ERROR);
+        return nullval;
+      }
+      if (owns_memory(f.type)) v = take_value({v, f.type}, loc, ctx);
+      if (f.heat == types::struct_::COLD) ctx.builder.CreateStore(v, ctx.builder.CreateStructGEP(st->cold->llvm_type(loc, ctx), cold, f.index));
+      else out = ctx.builder.CreateInsertValue(out, v, {f.index});
+    }
+    if (owns_memory(t)) ctx.temps.push_back({out, t});
+    return {out, t};
+  }
   auto self = val(ctx);
   std::vector<typed_value> args_v(args.size());
   for (std::size_t i = 0; i < args.size(); ++i) args_v[i] = args[i](ctx);
   auto tv = call(self, std::move(args_v), loc, ctx);
+  if (tv.type && owns_memory(tv.type)) ctx.temps.push_back(tv); // returned values are owned by the caller
   return tv;
 }
 typed_value cobalt::ast::fndef_ast::codegen(compile_context& ctx) const {
+  bool instance = ctx.instantiating && ctx.instantiating->first == this;
+  if (!tparams.empty() && !instance) {
+    // generic functions are generated when they're instantiated, see instantiate()
+    auto idx = name.rfind('.');
+    ctx.generics[this] = {ctx.vars, ctx.path, ctx.locals.depth() != 0};
+    ctx.define(sstring::get(idx == std::string::npos ? std::string_view(name) : name.substr(idx + 1)), typed_value{nullptr, types::generic::get(this, name)});
+    return nullval;
+  }
   std::vector<llvm::Type*> params_t(args.size());
   std::vector<type_ptr> args_t(args.size());
-  std::vector<std::string_view> old_path;
   for (std::size_t i = 0; i < args.size(); ++i) {
-    auto t = parse_type(args[i].second);
+    auto t = ctx.parse_type(args[i].second);
     if (!t) {
       ctx.flags.onerror(loc, (llvm::Twine("invalid type name '") + args[i].second + "' for function parameter").str(), ERROR);
       return nullval;
@@ -981,17 +1694,18 @@ typed_value cobalt::ast::fndef_ast::codegen(compile_context& ctx) const {
     args_t[i] = t;
     params_t[i] = t->llvm_type(loc, ctx);
   }
-  auto t = parse_type(ret);
+  auto t = ctx.parse_type(ret);
   if (!t) {
     ctx.flags.onerror(loc, (llvm::Twine("invalid type name '") + ret + "' for function return types").str(), ERROR);
     return nullval;
   }
-  bool is_extern = false, throws = false;
+  bool is_extern = false, throws = false, exported = false, is_main;
   std::string_view link_as = "";
   unsigned cconv = 8;
   {
     auto idx = name.rfind('.');
-    if ((idx != std::string::npos ? name.substr(idx) : std::string_view{name}) == "main") cconv = 0; // main should use C calling convention for compatibility
+    is_main = (idx != std::string::npos ? name.substr(idx) : std::string_view{name}) == "main";
+    if (is_main) cconv = 0; // main should use C calling convention for compatibility
   }
   llvm::GlobalValue::LinkageTypes link_type = llvm::GlobalValue::ExternalLinkage;
   bool ltset = false, ccset = false;
@@ -1018,6 +1732,11 @@ typed_value cobalt::ast::fndef_ast::codegen(compile_context& ctx) const {
       if (throws) ctx.flags.onerror(loc, "reuse of @throws annotation", ERROR);
       throws = true;
     }
+    else if (ann.starts_with("export(")) {
+      if (ann.size() != 8) ctx.flags.onerror(loc, "@export annotation should be used without arguments", ERROR);
+      if (exported) ctx.flags.onerror(loc, "reuse of @export annotation", ERROR);
+      exported = true;
+    }
     else if (ann.starts_with("linkas(")) {
       if (!link_as.empty()) ctx.flags.onerror(loc, "reuse of @linkas annotation", ERROR);
       link_as = std::string_view{ann.data() + 7, ann.size() - 8};
@@ -1053,6 +1772,14 @@ typed_value cobalt::ast::fndef_ast::codegen(compile_context& ctx) const {
     }
     else ctx.flags.onerror(loc, "unknown annotation @" + ann, ERROR);
   }
+  if (instance) {
+    if (is_extern || !link_as.empty()) {
+      ctx.flags.onerror(loc, "generic functions cannot be @extern or use @linkas", ERROR);
+      return nullval;
+    }
+    // every module that uses an instance gets its own copy, and the linker keeps one of them
+    if (!ltset) link_type = llvm::GlobalValue::LinkOnceODRLinkage;
+  }
   auto ft = llvm::FunctionType::get(t->llvm_type(loc, ctx), params_t, false);
   alignas(sstring) char local_mem[sizeof(sstring)];
   sstring& local = reinterpret_cast<sstring&>(local_mem[0]);
@@ -1061,44 +1788,38 @@ typed_value cobalt::ast::fndef_ast::codegen(compile_context& ctx) const {
     if (idx) local = sstring::get(name.substr(idx));
     else local = sstring::get(name);
   }
-  if (is_extern && !link_as.empty()) ctx.vars->insert(local, typed_value{llvm::GlobalAlias::create(ft, 0, link_type, concat(ctx.path, name), llvm::cast<llvm::Function>(ctx.module->getOrInsertFunction(link_as, ft).getCallee()), ctx.module.get()), types::function::get(t, std::vector<type_ptr>(args_t))});
+  if (is_extern && !link_as.empty()) ctx.define(local, typed_value{llvm::GlobalAlias::create(ft, 0, link_type, concat(ctx.path, name), llvm::cast<llvm::Function>(ctx.module->getOrInsertFunction(link_as, ft).getCallee()), ctx.module.get()), types::function::get(t, std::vector<type_ptr>(args_t))});
   else {
-    auto f = llvm::Function::Create(ft, link_type, name.front() == '.' ? std::string_view(name) : concat(ctx.path, name), *ctx.module);;
+    auto fname = name.front() == '.' ? std::string(name) : concat(ctx.path, name);
+    if (instance) {
+      // instances are mangled with their type arguments, like f[i32, f64]
+      fname += '[';
+      for (auto targ : ctx.instantiating->second) {
+        fname += targ->name();
+        fname += ", ";
+      }
+      fname.resize(fname.size() - 2);
+      fname += ']';
+    }
+    auto f = llvm::Function::Create(ft, link_type, fname, *ctx.module);
     if (!f) return nullval;
     f->setCallingConv(cconv);
     {
       std::size_t i = 0;
       for (auto& arg : f->args()) if (!args[i].first.empty()) arg.setName(args[i].first);
     }
-    ctx.vars->insert(local, typed_value{f, types::function::get(t, std::vector<type_ptr>(args_t))});
+    // instances are cached before their bodies are generated, so that they can call themselves
+    if (instance) ctx.instances[*ctx.instantiating] = typed_value{f, types::function::get(t, std::vector<type_ptr>(args_t))};
+    else ctx.define(local, typed_value{f, types::function::get(t, std::vector<type_ptr>(args_t))});
     if (!is_extern) {
-      if (name.front() == '.') {
-        old_path = ctx.path;
-        ctx.path = {name.substr(1)};
-      }
-      else ctx.path.push_back(name);
-      auto bb = llvm::BasicBlock::Create(*ctx.context, "entry", f);
-      auto ip = ctx.builder.GetInsertBlock();
-      ctx.builder.SetInsertPoint(bb);
-      ctx.vars = new varmap(ctx.vars);
-      for (std::size_t i = 0; i < args.size(); ++i) if (!args[i].first.empty()) ctx.vars->insert(args[i].first, typed_value{f->getArg(i), args_t[i]});
-      auto tv = body(ctx);
-      if (t->kind != NULLTYPE) {
-        if (!tv.type) ctx.builder.CreateRet(llvm::Constant::getNullValue(t->llvm_type(loc, ctx)));
-        else {
-          auto p = impl_convert(tv.value, tv.type, t, loc, ctx);
-          if (!p) ctx.builder.CreateRet(llvm::Constant::getNullValue(t->llvm_type(loc, ctx)));
-          else ctx.builder.CreateRet(p);
-        }
-        auto vars = ctx.vars;
-        ctx.vars = ctx.vars->parent;
-        delete vars;
-        ctx.builder.SetInsertPoint(ip);
-        if (!link_as.empty()) llvm::GlobalAlias::create(ft, 0, llvm::GlobalValue::ExternalLinkage, link_as, f, ctx.module.get());
+      // anything that could be referenced from outside of this module is always generated
+      if (ctx.flags.demand_codegen && !instance && !is_main && !exported && !ltset && link_as.empty() && !ctx.locals.depth()) {
+        ctx.deferred.try_emplace(f, compile_context::deferred_fn{this, f, types::function::get(t, std::vector<type_ptr>(args_t)), {ctx.vars, ctx.path, false}, ctx.vars->now()});
+        return nullval;
       }
-      else ctx.builder.CreateRetVoid();
-      if (name.front() == '.') std::swap(ctx.path, old_path);
-      else ctx.path.pop_back();
+      define_body(*this, f, t, args_t, ctx);
+      define_reachable(*f, ctx); // this body is emitted, so whatever it calls has to be too
+      if (!link_as.empty()) llvm::GlobalAlias::create(ft, 0, llvm::GlobalValue::ExternalLinkage, link_as, f, ctx.module.get());
     }
   }
   return nullval;
@@ -1111,7 +1832,7 @@ typed_value cobalt::ast::integer_ast::codegen(compile_context& ctx) const {
   switch (suffix.front()) {
     case 'i':
       if (suffix == isize) return {llvm::Constant::getIntegerValue(llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8), val), types::integer::get(sizeof(void*) * 8, false)};
-      else if (suffix.find_first_not_of("012456789", 1) == std::string::npos) {
+      else if (suffix.find_first_not_of("0123456789", 1) == std::string::npos) {
         unsigned width = 0;
         for (char c : suffix.substr(1)) {
           width *= 10;
@@ -1122,7 +1843,7 @@ typed_value cobalt::ast::integer_ast::codegen(compile_context& ctx) const {
       else goto UNKNOWN;
     case 'u':
       if (suffix == usize) return {llvm::Constant::getIntegerValue(llvm::Type::getIntNTy(*ctx.context, sizeof(void*) * 8), val), types::integer::get(sizeof(void*) * 8, true)};
-      else if (suffix.find_first_not_of("012456789", 1) == std::string::npos) {
+      else if (suffix.find_first_not_of("0123456789", 1) == std::string::npos) {
         unsigned width = 0;
         for (char c : suffix.substr(1)) {
           width *= 10;
@@ -1171,39 +1892,15 @@ typed_value cobalt::ast::char_ast::codegen(compile_context& ctx) const {
 }
 // scope.hpp
 typed_value cobalt::ast::module_ast::codegen(compile_context& ctx) const {
-  auto vm = ctx.vars;
+  auto const& path = *qpath::get(sstring::get(name));
+  auto vm = def_module(path, path.segments.size(), loc, ctx);
+  if (!vm) return nullval;
   std::vector<std::string_view> old_path;
   if (name.front() == '.') {
     old_path = ctx.path;
     ctx.path = {name.substr(1)};
   }
   else ctx.path.push_back(name);
-  if (name.front() == '.') while (vm->parent) vm = vm->parent;
-  std::size_t old = name.front() == '.', idx = name.find('.', 1);
-  while (idx != std::string::npos) {
-    auto local = name.substr(old + 1, idx - old - 1);
-    auto ss = sstring::get(local);
-    auto it = vm->symbols.find(ss);
-    old = idx;
-    idx = name.find('.', old);
-    if (it == vm->symbols.end()) {
-      if (it->second.index() == 2) vm = std::get<2>(it->second).get();
-      else {
-        ctx.flags.onerror(loc, name.substr(0, idx) + " is not a module", ERROR);
-        return nullval;
-      }
-    }
-    else {
-      auto nvm = std::make_shared<varmap>(vm);
-      vm->symbols.insert({ss, symbol_type(nvm)});
-      vm = nvm.get();
-    }
-  }
-  {
-    auto nvm = std::make_shared<varmap>(vm);
-    vm->symbols.insert({sstring::get(name.substr(old + 1)), symbol_type(nvm)});
-    vm = nvm.get();
-  }
   std::swap(vm, ctx.vars);
   for (auto const& i : insts) i(ctx);
   if (name.front() == '.') std::swap(ctx.path, old_path);
@@ -1219,71 +1916,52 @@ typed_value cobalt::ast::import_ast::codegen(compile_context& ctx) const {
       return nullval;
     }
   }
-  varmap* vm = ctx.vars;
-  if (path.front() == '.') while (vm->parent) vm = vm->parent;
-  std::size_t old = path.front() == '.', idx = path.find('.', 1);
-  while (idx != std::string::npos) {
-    auto local = path.substr(old, idx - old - 1);
-    auto ptr = vm->get(sstring::get(local));
-    if (ptr) {
-      auto pidx = ptr->index();
-      if (pidx == 2) vm = std::get<2>(*ptr).get();
-      else ctx.flags.onerror(loc, path.substr(0, idx) + " is not a module", ERROR);
+  auto idx = path.rfind('.');
+  std::size_t fail;
+  if (path.ends_with('*')) {
+    if (idx == std::string::npos) {
+      ctx.flags.onerror(loc, "cannot import everything from the current scope", ERROR);
+      return nullval;
     }
-    else {
-      ctx.flags.onerror(loc, path.substr(0, old) + " does not exist", ERROR);
+    auto mod = std::string_view(path).substr(0, idx);
+    auto ptr = ctx.resolve(mod, &fail);
+    if (!ptr || ptr->index() != 2) {
+      if (ptr) ctx.flags.onerror(loc, (llvm::Twine(mod) + " is not a module").str(), ERROR);
+      else unresolved(mod, fail, loc, ctx);
       return nullval;
     }
-    old = idx + 1;
-    idx = path.find('.', old);
-  }
-  if (path.substr(old) == "*") {
-    auto res = ctx.vars->include(vm);
-    for (auto const& sym : res) ctx.flags.onerror(loc, (llvm::Twine("conflicting definitions for '") + sym + "' in '" + concat(ctx.path, "") + "' and '" + path + "'").str(), ERROR);
+    auto const& vm = std::get<2>(*ptr);
+    if (ctx.locals.depth()) {
+      for (auto const& sym : ctx.locals.import(vm)) ctx.flags.onerror(loc, (llvm::Twine("conflicting definitions for '") + sym + "' in local scope and '" + path + "'").str(), ERROR);
+    }
+    else {
+      for (auto const& sym : ctx.vars->import(vm)) ctx.flags.onerror(loc, (llvm::Twine("conflicting definitions for '") + sym + "' in '" + concat(ctx.path, "") + "' and '" + path + "'").str(), ERROR);
+    }
     return nullval;
   }
-  auto ss = sstring::get(path.substr(old));
-  auto ptr = vm->get(ss);
+  auto ptr = ctx.resolve(path, &fail);
   if (!ptr) {
-    ctx.flags.onerror(loc, path + " does not exist", ERROR);
+    unresolved(path, fail, loc, ctx);
+    return nullval;
+  }
+  auto ss = sstring::get(idx == std::string::npos ? std::string_view(path) : std::string_view(path).substr(idx + 1));
+  if (ctx.locals.depth()) {
+    if (!ctx.locals.insert(ss, *ptr)) ctx.flags.onerror(loc, (llvm::Twine("conflicting definitions for '") + ss + "' in local scope and '" + path + "'").str(), ERROR);
     return nullval;
   }
-  auto [it, succ] = ctx.vars->symbols.insert({ss, *ptr});
+  auto [sym, succ] = ctx.vars->emplace(ss, *ptr);
   if (!succ) {
-    if (ptr->index() == it->second.index() && ptr->index() == 2) std::get<2>(it->second)->include(std::get<2>(*ptr).get());
-    else ctx.flags.onerror(loc, (llvm::Twine("conflicting definitions for '") + ss + "' in '" + concat(ctx.path, "") + "' and '" + path + "'").str(), ERROR);
+    if (ptr->index() == sym->index() && ptr->index() == 2) std::get<2>(*sym)->import(std::get<2>(*ptr));
+    else if (!same_symbol(*ptr, *sym)) ctx.flags.onerror(loc, (llvm::Twine("conflicting definitions for '") + ss + "' in '" + concat(ctx.path, "") + "' and '" + path + "'").str(), ERROR);
   }
   return nullval;
 }
 // vars.hpp
 typed_value cobalt::ast::vardef_ast::codegen(compile_context& ctx) const {
-  varmap* vm = ctx.vars;
-  if (name.front() == '.') while (vm->parent) vm = vm->parent;
-  std::size_t old = name.front() == '.', idx = name.find('.', 1);
-  while (idx != std::string::npos) {
-    auto local = name.substr(old , idx - old - 1);
-    auto ss = sstring::get(local);
-    auto it = vm->symbols.find(ss);
-    if (idx == std::string::npos) {
-      if (it != vm->symbols.end()) ctx.flags.onerror(loc, "redefinition of " + name, ERROR);
-      else break;
-    }
-    else {
-      if (it == vm->symbols.end()) {
-        auto nvm = std::make_shared<varmap>(vm);
-        vm->symbols.insert({ss, symbol_type(nvm)});
-        vm = nvm.get();
-      }
-      else if (it->second.index() == 2) vm = std::get<2>(it->second).get();
-      else {
-        ctx.flags.onerror(loc, name.substr(0, idx) + " is not a module", ERROR);
-        return nullval;
-      }
-    }
-    old = idx + 1;
-    idx = name.find('.', old);
-  }
-  auto local = name.substr(old);
+  auto const& path = *qpath::get(name);
+  varmap* vm = def_module(path, path.segments.size() - 1, loc, ctx);
+  if (!vm) return nullval;
+  std::string_view local = path.segments.back();
   std::vector<std::string_view> old_path;
   std::string_view link_as = "";
   llvm::GlobalValue::LinkageTypes link_type = global ? llvm::GlobalValue::ExternalLinkage : llvm::GlobalValue::PrivateLinkage;
@@ -1328,8 +2006,9 @@ typed_value cobalt::ast::vardef_ast::codegen(compile_context& ctx) const {
       if (!tv.type) return nullval;
       auto ct = tv.type->kind == INTEGER && !static_cast<types::integer const*>(tv.type)->nbits ? types::integer::get(64) : tv.type;
       auto gv = new llvm::GlobalVariable(*ctx.module, ct->llvm_type(loc, ctx), true, link_type, llvm::cast<llvm::Constant>(tv.value), name.front() == '.' ? std::string_view(name) : std::string_view(concat(ctx.path, name)));
+      set_align(gv, ct);
       auto type = types::reference::get(ct);
-      vm->insert(sstring::get(local), typed_value{gv, type});
+      define(vm, local, typed_value{gv, type}, ctx);
       return {gv, type};
     }
     else {
@@ -1338,8 +2017,14 @@ typed_value cobalt::ast::vardef_ast::codegen(compile_context& ctx) const {
       auto f = llvm::Function::Create(ft, llvm::GlobalValue::LinkageTypes::PrivateLinkage, "global.init." + llvm::Twine(ctx.init_count++), ctx.module.get());
       if (!f) return nullval;
       auto rt = val.type(ctx);
+      if (!rt) {
+        f->eraseFromParent();
+        ctx.flags.onerror(loc, "cannot determine the type of the initializer for " + name, ERROR);
+        return nullval;
+      }
       auto ct = rt->kind == INTEGER && !static_cast<types::integer const*>(rt)->nbits ? types::integer::get(64) : rt;
-      auto gv = new llvm::GlobalVariable(*ctx.module, ct->llvm_type(loc, ctx), true, link_type, nullptr, name.front() == '.' ? std::string_view(name) : std::string_view(concat(ctx.path, name)));
+      auto gv = new llvm::GlobalVariable(*ctx.module, ct->llvm_type(loc, ctx), false, link_type, llvm::Constant::getNullValue(ct->llvm_type(loc, ctx)), name.front() == '.' ? std::string_view(name) : std::string_view(concat(ctx.path, name)));
+      set_align(gv, ct);
       auto bb = llvm::BasicBlock::Create(*ctx.context, "entry", f);
       ctx.builder.SetInsertPoint(bb);
       if (name.front() == '.') {
@@ -1347,19 +2032,32 @@ typed_value cobalt::ast::vardef_ast::codegen(compile_context& ctx) const {
         ctx.path = {name.substr(1)};
       }
       else ctx.path.push_back(name);
+      decltype(ctx.temps) temps;
+      std::swap(ctx.temps, temps);
       auto tv = val(ctx);
       if (name.front() == '.') std::swap(ctx.path, old_path);
       else ctx.path.pop_back();
       if (!tv.type) {
+        std::swap(ctx.temps, temps);
         f->eraseFromParent();
         gv->eraseFromParent();
         return nullval;
       }
-      ctx.builder.CreateStore(tv.value, gv);
+      // globals live until the program exits, so what they own is never freed
+      ctx.builder.CreateStore(owns_memory(tv.type) ? take_value(tv, loc, ctx) : tv.value, gv);
+      free_temps(0, nullptr, loc, ctx);
+      std::swap(ctx.temps, temps);
       ctx.builder.CreateRetVoid();
       ctx.builder.SetInsertPoint((llvm::BasicBlock*)nullptr);
+      define_reachable(*f, ctx); // the initializer can only be run at compile time once the functions it calls have bodies
+      // initializers are run at compile time if they can be, so that the result is emitted as read-only data
+      if (!ctx.runtime_init && fold_global_init(*f, *gv)) gv->setConstant(true);
+      else {
+        ctx.runtime_init = true;
+        llvm::appendToGlobalCtors(*ctx.module, f, 65535);
+      }
       auto type = types::reference::get(ct);
-      vm->insert(sstring::get(local), typed_value{gv, type});
+      define(vm, local, typed_value{gv, type}, ctx);
       return {gv, type};
     }
   }
@@ -1375,39 +2073,20 @@ typed_value cobalt::ast::vardef_ast::codegen(compile_context& ctx) const {
     if (name.front() == '.') std::swap(ctx.path, old_path);
     else ctx.path.pop_back();
     if (!tv.type) return nullval;
+    if (owns_memory(tv.type)) {
+      tv.value = take_value(tv, loc, ctx);
+      ctx.owned.push_back({tv, ctx.locals.depth()});
+    }
     if (!llvm::isa<llvm::GlobalValue>(tv.value)) tv.value->setName(name);
-    vm->insert(sstring::get(local), tv.type->kind == INTEGER && !static_cast<types::integer const*>(tv.type)->nbits ? typed_value{tv.value, types::integer::get(64)} : tv);
+    define(vm, local, tv.type->kind == INTEGER && !static_cast<types::integer const*>(tv.type)->nbits ? typed_value{tv.value, types::integer::get(64)} : tv, ctx);
     return tv;
   }
 }
 typed_value cobalt::ast::mutdef_ast::codegen(compile_context& ctx) const {
-  varmap* vm = ctx.vars;
-  if (name.front() == '.') while (vm->parent) vm = vm->parent;
-  std::size_t old = name.front() == '.', idx = name.find('.', 1);
-  while (idx != std::string::npos) {
-    auto local = name.substr(old , idx - old - 1);
-    auto ss = sstring::get(local);
-    auto it = vm->symbols.find(ss);
-    if (idx == std::string::npos) {
-      if (it != vm->symbols.end()) ctx.flags.onerror(loc, "redefinition of " + name, ERROR);
-      else break;
-    }
-    else {
-      if (it == vm->symbols.end()) {
-        auto nvm = std::make_shared<varmap>(vm);
-        vm->symbols.insert({ss, symbol_type(nvm)});
-        vm = nvm.get();
-      }
-      else if (it->second.index() == 2) vm = std::get<2>(it->second).get();
-      else {
-        ctx.flags.onerror(loc, name.substr(0, idx) + " is not a module", ERROR);
-        return nullval;
-      }
-    }
-    old = idx + 1;
-    idx = name.find('.', old);
-  }
-  auto local = name.substr(old);
+  auto const& path = *qpath::get(name);
+  varmap* vm = def_module(path, path.segments.size() - 1, loc, ctx);
+  if (!vm) return nullval;
+  std::string_view local = path.segments.back();
   std::vector<std::string_view> old_path;
   if (global) {
     if (val.is_const()) {
@@ -1422,8 +2101,9 @@ typed_value cobalt::ast::mutdef_ast::codegen(compile_context& ctx) const {
       if (!tv.type) return nullval;
       auto ct = tv.type->kind == INTEGER && !static_cast<types::integer const*>(tv.type)->nbits ? types::integer::get(64) : tv.type;
       auto gv = new llvm::GlobalVariable(*ctx.module, ct->llvm_type(loc, ctx), false, llvm::GlobalValue::LinkageTypes::ExternalLinkage, llvm::cast<llvm::Constant>(tv.value), name.front() == '.' ? std::string_view(name) : std::string_view(concat(ctx.path, name)));
+      set_align(gv, ct);
       auto type = types::reference::get(ct);
-      vm->insert(sstring::get(local), typed_value{gv, type});
+      define(vm, local, typed_value{gv, type}, ctx);
       return {gv, type};
     }
     else {
@@ -1432,8 +2112,14 @@ typed_value cobalt::ast::mutdef_ast::codegen(compile_context& ctx) const {
       auto f = llvm::Function::Create(ft, llvm::GlobalValue::LinkageTypes::PrivateLinkage, "global.init." + llvm::Twine(ctx.init_count++), ctx.module.get());
       if (!f) return nullval;
       auto rt = val.type(ctx);
+      if (!rt) {
+        f->eraseFromParent();
+        ctx.flags.onerror(loc, "cannot determine the type of the initializer for " + name, ERROR);
+        return nullval;
+      }
       auto ct = rt->kind == INTEGER && !static_cast<types::integer const*>(rt)->nbits ? types::integer::get(64) : rt;
-      auto gv = new llvm::GlobalVariable(*ctx.module, ct->llvm_type(loc, ctx), false, llvm::GlobalValue::LinkageTypes::ExternalLinkage, nullptr, name.front() == '.' ? std::string_view(name) : std::string_view(concat(ctx.path, name)));
+      auto gv = new llvm::GlobalVariable(*ctx.module, ct->llvm_type(loc, ctx), false, llvm::GlobalValue::LinkageTypes::ExternalLinkage, llvm::Constant::getNullValue(ct->llvm_type(loc, ctx)), name.front() == '.' ? std::string_view(name) : std::string_view(concat(ctx.path, name)));
+      set_align(gv, ct);
       auto bb = llvm::BasicBlock::Create(*ctx.context, "entry", f);
       ctx.builder.SetInsertPoint(bb);
       if (name.front() == '.') {
@@ -1441,19 +2127,30 @@ typed_value cobalt::ast::mutdef_ast::codegen(compile_context& ctx) const {
         ctx.path = {name.substr(1)};
       }
       else ctx.path.push_back(name);
+      decltype(ctx.temps) temps;
+      std::swap(ctx.temps, temps);
       auto tv = val(ctx);
       if (name.front() == '.') std::swap(ctx.path, old_path);
       else ctx.path.pop_back();
       if (!tv.type) {
+        std::swap(ctx.temps, temps);
         f->eraseFromParent();
         gv->eraseFromParent();
         return nullval;
       }
-      ctx.builder.CreateStore(tv.value, gv);
+      // globals live until the program exits, so what they own is never freed
+      ctx.builder.CreateStore(owns_memory(tv.type) ? take_value(tv, loc, ctx) : tv.value, gv);
+      free_temps(0, nullptr, loc, ctx);
+      std::swap(ctx.temps, temps);
       ctx.builder.CreateRetVoid();
       ctx.builder.SetInsertPoint((llvm::BasicBlock*)nullptr);
+      define_reachable(*f, ctx);
+      if (ctx.runtime_init || !fold_global_init(*f, *gv)) {
+        ctx.runtime_init = true;
+        llvm::appendToGlobalCtors(*ctx.module, f, 65535);
+      }
       auto type = types::reference::get(ct);
-      vm->insert(sstring::get(local), typed_value{gv, type});
+      define(vm, local, typed_value{gv, type}, ctx);
       return {gv, type};
     }
   }
@@ -1480,40 +2177,43 @@ typed_value cobalt::ast::mutdef_ast::codegen(compile_context& ctx) const {
         if (static_cast<types::pointer const*>(tv.type)->base->kind == FUNCTION) a = ctx.builder.CreateAlloca(llvm::Type::getInt8PtrTy(*ctx.context), nullptr, name);
         else goto ALLOCA_DEFAULT;
         break;
-      default: ALLOCA_DEFAULT:
-        a = ctx.builder.CreateAlloca(tv.type->llvm_type(loc, ctx), nullptr, name);
+      default: ALLOCA_DEFAULT: {
+        auto ai = ctx.builder.CreateAlloca(tv.type->llvm_type(loc, ctx), nullptr, name);
+        set_align(ai, tv.type);
+        a = ai;
+      }
     }
-    ctx.builder.CreateStore(tv.value, a);
+    bool owns = owns_memory(tv.type);
+    ctx.builder.CreateStore(owns ? take_value(tv, loc, ctx) : tv.value, a);
     auto type = types::reference::get(tv.type->kind == INTEGER && !static_cast<types::integer const*>(tv.type)->nbits ? types::integer::get(64) : tv.type);
-    vm->insert(sstring::get(local), typed_value{a, type});
+    if (owns) ctx.owned.push_back({{a, type}, ctx.locals.depth()});
+    define(vm, local, typed_value{a, type}, ctx);
     return {a, type};
   }
 }
 typed_value cobalt::ast::varget_ast::codegen(compile_context& ctx) const {
-  varmap* vm = ctx.vars;
-  if (name.front() == '.') while (vm->parent) vm = vm->parent;
-  std::size_t old = name.front() == '.', idx = name.find('.', 1);
-  while (idx != std::string::npos) {
-    auto local = name.substr(old, idx - old - 1);
-    auto ptr = vm->get(sstring::get(local));
-    if (ptr) {
-      auto pidx = ptr->index();
-      if (pidx == 2) vm = std::get<2>(*ptr).get();
-      else ctx.flags.onerror(loc, name.substr(0, idx) + " is not a module", ERROR);
-    }
-    else {
-      ctx.flags.onerror(loc, name.substr(0, old) + " does not exist", ERROR);
-      return nullval;
-    }
-    old = idx + 1;
-    idx = name.find('.', old);
+  auto const& path = *qpath::get(name);
+  std::size_t fail, nvar;
+  auto ptr = ctx.resolve_var(path, nvar, &fail);
+  if (!ptr) {
+    unresolved(name, fail, loc, ctx);
+    return nullval;
   }
-  auto ptr = vm->get(sstring::get(name.substr(old)));
-  if (ptr) {
-    auto idx = ptr->index();
-    if (idx == 0) return std::get<0>(*ptr);
-    else ctx.flags.onerror(loc, name + " is not a variable", ERROR);
+  if (ptr->index() != 0) {
+    ctx.flags.onerror(loc, name + " is not a variable", ERROR);
+    return nullval;
   }
-  else ctx.flags.onerror(loc, name + " does not exist", ERROR);
+  auto tv = std::get<0>(*ptr);
+  for (auto i = nvar; tv.type && i < path.segments.size(); ++i) tv = get_field(tv, path.segments[i], loc, ctx);
+  return tv;
+}
+// typedefs.hpp
+typed_value cobalt::ast::structdef_ast::codegen(compile_context& ctx) const {
+  auto t = struct_type(ctx, true);
+  if (!t) return nullval;
+  auto const& path = *qpath::get(name);
+  auto vm = def_module(path, path.segments.size() - 1, loc, ctx);
+  if (!vm) return nullval;
+  if (!define(vm, path.segments.back(), t, ctx)) ctx.flags.onerror(loc, "redefinition of " + name, ERROR);
   return nullval;
 }
@@ -0,0 +1,205 @@
+#include "cobalt/fold.hpp"
+#include "cobalt/ast.hpp"
+#include "cobalt/types.hpp"
+#include <cmath>
+#include <optional>
+using namespace cobalt;
+using enum types::type_base::kind_t;
+namespace {
+  // how a node's value is used by its parent, let constants aren't substituted where an lvalue is expected
+  enum use_t {ANY, VALUE, LVALUE};
+  int nbits(type_ptr t) {return static_cast<types::integer const*>(t)->nbits;}
+  // the suffix of a literal of integer type t, untyped literals don't have one
+  sstring int_suffix(type_ptr t) {
+    auto b = nbits(t);
+    if (!b) return sstring::get("");
+    return sstring::get((llvm::Twine(b < 0 ? "u" : "i") + llvm::Twine(b < 0 ? -b : b)).str());
+  }
+  // the value of a literal in the width of its type, untyped literals are stored as i64 so anything else is left for codegen
+  std::optional<llvm::APInt> int_value(ast::integer_ast const& n, type_ptr t) {
+    auto b = nbits(t);
+    if (!b) {
+      if (n.val.getBitWidth() != 64) return std::nullopt;
+      return n.val;
+    }
+    return b < 0 ? n.val.zextOrTrunc(-b) : n.val.sextOrTrunc(b);
+  }
+  struct folder {
+    base_context& ctx;
+    // let constants visible in each scope, null entries are names that something else shadows
+    struct scope {
+      std::unordered_map<sstring, ast::ast_base const*> consts;
+      bool opaque = false; // an import could have brought any name into scope
+    };
+    std::vector<scope> scopes = {{}};
+    folder(base_context& ctx) : ctx(ctx) {}
+    ast::ast_base const* lookup(sstring name) const {
+      for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+        if (auto c = it->consts.find(name); c != it->consts.end()) return c->second;
+        if (it->opaque) return nullptr;
+      }
+      return nullptr;
+    }
+    void bind(sstring name, ast::ast_base const* val) {
+      if (name.find('.') != std::string::npos) return; // definitions in other modules don't shadow local names
+      scopes.back().consts[name] = scopes.back().opaque ? nullptr : val;
+    }
+    void operator()(AST& ast, use_t use = ANY) {
+      if (ast) ast::visit(*ast.get(), [&] (auto& n) {visit_node(n, ast, use);});
+    }
+    template <class T> void visit_node(T& n, AST&, use_t) {ast::for_each_child(static_cast<ast::ast_base&>(n), [this] (AST& child) {(*this)(child);});}
+    void visit_node(ast::block_ast& n, AST&, use_t) {
+      scopes.emplace_back();
+      for (auto& i : n.insts) (*this)(i);
+      scopes.pop_back();
+    }
+    void visit_node(ast::module_ast& n, AST&, use_t) {
+      scopes.emplace_back();
+      for (auto& i : n.insts) (*this)(i);
+      scopes.pop_back();
+    }
+    void visit_node(ast::import_ast&, AST&, use_t) {
+      scopes.back().consts.clear();
+      scopes.back().opaque = true;
+    }
+    void visit_node(ast::fndef_ast& n, AST&, use_t) {
+      auto idx = n.name.rfind('.');
+      bind(sstring::get(idx == std::string::npos ? std::string_view(n.name) : n.name.substr(idx + 1)), nullptr);
+      if (!n.body_parsed()) return;
+      scopes.emplace_back();
+      for (auto const& [name, _] : n.args) if (!name.empty()) bind(name, nullptr);
+      (*this)(n.body);
+      scopes.pop_back();
+    }
+    void visit_node(ast::structdef_ast& n, AST&, use_t) {bind(n.name, nullptr);}
+    void visit_node(ast::vardef_ast& n, AST&, use_t) {
+      (*this)(n.val);
+      bool is_const = n.annotations.empty() && (n.val.dyn_cast<ast::integer_ast>() || n.val.dyn_cast<ast::float_ast>()); // @link could replace the value at link time
+      bind(n.name, is_const ? n.val.get() : nullptr);
+    }
+    void visit_node(ast::mutdef_ast& n, AST&, use_t) {
+      (*this)(n.val);
+      bind(n.name, nullptr);
+    }
+    void visit_node(ast::varget_ast& n, AST& self, use_t use) {
+      if (use == LVALUE || n.name.find('.') != std::string::npos) return;
+      auto c = lookup(n.name);
+      if (!c) return;
+      // globals are references, which can only be replaced by a value where one is expected
+      if (use != VALUE && (!n.annotated || !n.cached_type || n.cached_type->kind == REFERENCE)) return;
+      if (auto i = ast::ast_cast<ast::integer_ast>(c)) self = AST::create<ast::integer_ast>(n.loc, i->val, i->suffix.empty() ? sstring::get("i64") : i->suffix); // untyped literals are stored as i64
+      else if (auto f = ast::ast_cast<ast::float_ast>(c)) self = AST::create<ast::float_ast>(n.loc, f->val, f->suffix);
+    }
+    // x is the operand an identity leaves, it can only replace the whole expression if that doesn't change the type
+    bool same_type(AST const& x, ast::ast_base const& n, use_t use) {
+      if (!n.annotated || !n.cached_type) return false;
+      auto t = x.type(ctx);
+      if (t && use == VALUE && t->kind == REFERENCE) t = static_cast<types::reference const*>(t)->base;
+      return t == n.cached_type;
+    }
+    void visit_node(ast::unop_ast& n, AST& self, use_t use) {
+      (*this)(n.val, n.op == OP_AMP || n.op == OP_INC || n.op == OP_DEC ? LVALUE : VALUE);
+      if (auto i = n.val.dyn_cast<ast::integer_ast>()) {
+        auto t = i->type(ctx);
+        if (!t || t->kind != INTEGER) return;
+        auto v = int_value(*i, t);
+        if (!v) return;
+        switch (n.op) {
+          case OP_PLUS: self = AST::create<ast::integer_ast>(n.loc, *v, i->suffix); break;
+          case OP_MINUS: self = AST::create<ast::integer_ast>(n.loc, -*v, i->suffix); break;
+          case OP_TILDE: self = AST::create<ast::integer_ast>(n.loc, ~*v, i->suffix); break;
+          case OP_BANG: self = AST::create<ast::integer_ast>(n.loc, llvm::APInt(1, v->isZero()), sstring::get("i1")); break;
+          default: break;
+        }
+      }
+      else if (auto f = n.val.dyn_cast<ast::float_ast>()) switch (n.op) {
+        case OP_PLUS: self = AST::create<ast::float_ast>(n.loc, f->val, f->suffix); break;
+        case OP_MINUS: self = AST::create<ast::float_ast>(n.loc, -f->val, f->suffix); break;
+        case OP_BANG: self = AST::create<ast::integer_ast>(n.loc, llvm::APInt(1, f->val == 0), sstring::get("i1")); break;
+        default: break;
+      }
+      else if (auto u = n.val.dyn_cast<ast::unop_ast>(); u && n.op == OP_BANG && u->op == OP_BANG && u->val.type(ctx) && same_type(u->val, n, use)) {
+        AST b = std::move(u->val);
+        self = std::move(b);
+      }
+    }
+    void visit_node(ast::binop_ast& n, AST& self, use_t use) {
+      bool assign = n.op >= OP_ASSIGN && n.op <= OP_SHR_ASSIGN;
+      (*this)(n.lhs, assign ? LVALUE : VALUE);
+      (*this)(n.rhs, VALUE);
+      if (assign) return;
+      auto li = n.lhs.dyn_cast<ast::integer_ast>(), ri = n.rhs.dyn_cast<ast::integer_ast>();
+      if (li && ri) {
+        if (auto v = fold_int(n, *li, *ri)) self = std::move(v);
+        return;
+      }
+      auto lf = n.lhs.dyn_cast<ast::float_ast>(), rf = n.rhs.dyn_cast<ast::float_ast>();
+      if (lf && rf) {
+        if (auto v = fold_float(n, *lf, *rf)) self = std::move(v);
+        return;
+      }
+      // identities on integers
+      auto is = [] (ast::integer_ast const* i, bool one) {return i && (one ? i->val.isOne() : i->val.isZero());};
+      AST* x = nullptr;
+      switch (n.op) {
+        case OP_PLUS: case OP_PIPE: case OP_CARET: x = is(ri, false) ? &n.lhs : is(li, false) ? &n.rhs : nullptr; break;
+        case OP_MINUS: case OP_SHL: case OP_SHR: x = is(ri, false) ? &n.lhs : nullptr; break;
+        case OP_STAR: x = is(ri, true) ? &n.lhs : is(li, true) ? &n.rhs : nullptr; break;
+        case OP_SLASH: x = is(ri, true) ? &n.lhs : nullptr; break;
+        default: break;
+      }
+      if (x && n.cached_type && n.cached_type->kind == INTEGER && same_type(*x, n, use)) {
+        AST keep = std::move(*x);
+        self = std::move(keep);
+      }
+    }
+    // integer operations are done in the width of the result type, and are left alone when they'd be poison in LLVM
+    AST fold_int(ast::binop_ast const& n, ast::integer_ast const& l, ast::integer_ast const& r) {
+      auto lt = l.type(ctx), rt = r.type(ctx), t = n.type(ctx);
+      if (!lt || !rt || !t || lt->kind != INTEGER || rt->kind != INTEGER || t->kind != INTEGER) return nullptr;
+      auto lv = int_value(l, lt), rv = int_value(r, rt);
+      if (!lv || !rv) return nullptr;
+      unsigned width = nbits(t) ? std::abs(nbits(t)) : 64;
+      auto a = nbits(lt) < 0 ? lv->zextOrTrunc(width) : lv->sextOrTrunc(width), b = nbits(rt) < 0 ? rv->zextOrTrunc(width) : rv->sextOrTrunc(width);
+      bool is_unsigned = nbits(lt) < 0 && nbits(rt) < 0; // codegen only divides unsigned if both sides are
+      llvm::APInt out;
+      switch (n.op) {
+        case OP_PLUS: out = a + b; break;
+        case OP_MINUS: out = a - b; break;
+        case OP_STAR: out = a * b; break;
+        case OP_SLASH:
+        case OP_PERCENT:
+          if (b.isZero() || (!is_unsigned && a.isMinSignedValue() && b.isAllOnes())) return nullptr;
+          if (n.op == OP_SLASH) out = is_unsigned ? a.udiv(b) : a.sdiv(b);
+          else out = is_unsigned ? a.urem(b) : a.srem(b);
+          break;
+        case OP_AMP: out = a & b; break;
+        case OP_PIPE: out = a | b; break;
+        case OP_CARET: out = a ^ b; break;
+        case OP_SHL:
+        case OP_SHR:
+          if (b.uge(width)) return nullptr;
+          out = n.op == OP_SHL ? a.shl(b) : a.lshr(b);
+          break;
+        default: return nullptr;
+      }
+      return AST::create<ast::integer_ast>(n.loc, std::move(out), int_suffix(t));
+    }
+    // only doubles are folded, since the literal can't hold a more precise result and narrower floats would have to be rounded at each step
+    AST fold_float(ast::binop_ast const& n, ast::float_ast const& l, ast::float_ast const& r) {
+      auto t = n.type(ctx);
+      if (!t || t != types::float64::get() || l.type(ctx) != t || r.type(ctx) != t) return nullptr;
+      double out;
+      switch (n.op) {
+        case OP_PLUS: out = l.val + r.val; break;
+        case OP_MINUS: out = l.val - r.val; break;
+        case OP_STAR: out = l.val * r.val; break;
+        case OP_SLASH: out = l.val / r.val; break;
+        case OP_PERCENT: out = std::fmod(l.val, r.val); break;
+        default: return nullptr;
+      }
+      return AST::create<ast::float_ast>(n.loc, out, l.suffix);
+    }
+  };
+}
+void cobalt::fold(AST& ast, base_context& ctx) {folder{ctx}(ast);}
@@ -0,0 +1,66 @@
+#include "cobalt/optimize.hpp"
+#include <llvm/ADT/Triple.h>
+#include <llvm/Analysis/AssumptionCache.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/ScalarEvolution.h>
+#include <llvm/Analysis/TargetLibraryInfo.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Transforms/Utils/BasicBlockUtils.h>
+#include <llvm/Transforms/Utils/Evaluator.h>
+#include <llvm/Transforms/Utils/Local.h>
+#include <llvm/Transforms/Utils/PromoteMemToReg.h>
+void cobalt::elide_bounds_checks(llvm::Function& f) {
+  std::vector<llvm::ICmpInst*> checks;
+  for (auto& bb : f) for (auto& inst : bb) if (inst.getMetadata(bounds_check_md)) checks.push_back(llvm::cast<llvm::ICmpInst>(&inst));
+  if (checks.empty()) return;
+  {
+    llvm::DominatorTree dt(f);
+    llvm::AssumptionCache ac(f);
+    std::vector<llvm::AllocaInst*> allocas;
+    for (auto& inst : f.getEntryBlock()) if (auto a = llvm::dyn_cast<llvm::AllocaInst>(&inst); a && llvm::isAllocaPromotable(a)) allocas.push_back(a);
+    if (!allocas.empty()) llvm::PromoteMemToReg(allocas, dt, &ac);
+  }
+  llvm::DominatorTree dt(f);
+  llvm::LoopInfo li(dt);
+  llvm::AssumptionCache ac(f);
+  llvm::TargetLibraryInfoImpl tlii(llvm::Triple(f.getParent()->getTargetTriple()));
+  llvm::TargetLibraryInfo tli(tlii, &f);
+  llvm::ScalarEvolution se(f, tli, ac, dt, li);
+  std::vector<llvm::BasicBlock*> changed, passed;
+  for (auto cmp : checks) {
+    // every check is i < len, unsigned, so negative indices fail too
+    auto i = cmp->getOperand(0), len = cmp->getOperand(1);
+    bool safe = se.isKnownPredicateAt(llvm::ICmpInst::ICMP_ULT, se.getSCEV(i), se.getSCEV(len), cmp);
+    if (!safe) {
+      // ranges from masks and remainders that SCEV doesn't track
+      auto ir = llvm::computeConstantRange(i, false, true, &ac, cmp, &dt), lr = llvm::computeConstantRange(len, false, true, &ac, cmp, &dt);
+      safe = ir.getUnsignedMax().ult(lr.getUnsignedMin());
+    }
+    if (!safe) continue;
+    if (auto br = llvm::dyn_cast<llvm::BranchInst>(cmp->user_back())) passed.push_back(br->getSuccessor(0));
+    cmp->replaceAllUsesWith(llvm::ConstantInt::getTrue(cmp->getContext()));
+    changed.push_back(cmp->getParent());
+    cmp->eraseFromParent();
+  }
+  // the failure paths of the removed checks are now unreachable
+  for (auto bb : changed) llvm::ConstantFoldTerminator(bb, true);
+  llvm::removeUnreachableBlocks(f);
+  for (auto bb : passed) llvm::MergeBlockIntoPredecessor(bb);
+}
+bool cobalt::fold_global_init(llvm::Function& init, llvm::GlobalVariable& gv) {
+  auto& mod = *init.getParent();
+  llvm::TargetLibraryInfoImpl tlii(llvm::Triple(mod.getTargetTriple()));
+  llvm::TargetLibraryInfo tli(tlii, &init);
+  llvm::Evaluator eval(mod.getDataLayout(), &tli);
+  llvm::Constant* ret;
+  llvm::SmallVector<llvm::Constant*, 0> args;
+  if (!eval.EvaluateFunction(&init, ret, args)) return false;
+  auto inits = eval.getMutatedInitializers();
+  if (inits.size() != 1 || inits.begin()->first != &gv) return false;
+  gv.setInitializer(inits.begin()->second);
+  init.eraseFromParent();
+  return true;
+}
@@ -1,12 +1,17 @@
 #include "cobalt/parser.hpp"
 #include "cobalt/ast.hpp"
 #include <array>
+#include <atomic>
+#include <cctype>
+#include <unordered_map>
+#include <thread>
 using namespace cobalt;
 struct binary_operator {
   std::string_view op;
+  op_t id;
   bool rtl;
-  binary_operator(std::string_view op, bool rtl = false) : op(op), rtl(rtl) {}
-  binary_operator(const char* c) : op(c), rtl(false) {}
+  binary_operator(std::string_view op, bool rtl = false) : op(op), id(op_id(op)), rtl(rtl) {}
+  binary_operator(const char* c) : op(c), id(op_id(c)), rtl(false) {}
   operator bool() const noexcept {return (bool)op.size();}
 };
 std::array<binary_operator, 42> bin_ops = {
@@ -23,8 +28,8 @@ std::array<binary_operator, 42> bin_ops = {
   "*", "/", "%", "",
   {"^^", true}
 };
-std::array<std::string_view, 8> pre_ops = {"+", "-", "&", "*", "!", "~", "++", "--"};
-std::array<std::string_view, 2> post_ops = {"?", "!"};
+std::array<std::pair<std::string_view, op_t>, 8> pre_ops = {{{"+", OP_PLUS}, {"-", OP_MINUS}, {"&", OP_AMP}, {"*", OP_STAR}, {"!", OP_BANG}, {"~", OP_TILDE}, {"++", OP_INC}, {"--", OP_DEC}}};
+std::array<std::pair<std::string_view, op_t>, 2> post_ops = {{{"?", OP_POST_QUESTION}, {"!", OP_POST_BANG}}};
 std::pair<AST, span<token>::iterator> parse_statement(span<token> code, flags_t flags);
 std::pair<AST, span<token>::iterator> parse_expr(span<token> code, flags_t flags, std::string_view exit_chars = ";");
 AST parse_rtl_infix(span<token> code, flags_t flags, binary_operator const* start);
@@ -67,6 +72,45 @@ std::vector<std::string> parse_paths(span<token>::iterator& it, span<token>::ite
   }
   return paths;
 }
+// parses the type parameters of a generic function, starting on the '[' and stopping on the ']'
+std::vector<sstring> parse_tparams(span<token>::iterator& it, span<token>::iterator end, flags_t flags) {
+  std::vector<sstring> tparams;
+  bool lwc = true; // last was comma
+  while (++it != end) {
+    std::string_view data = it->data;
+    switch (data.front()) {
+      case ']':
+        if (tparams.empty()) flags.onerror(it->loc, "generic functions must have at least one type parameter", ERROR);
+        return tparams;
+      case ',':
+        if (lwc) flags.onerror(it->loc, "expected a type parameter before comma", ERROR);
+        lwc = true;
+        break;
+      case '0':
+      case '1':
+      case '"':
+      case '\'':
+      case '.':
+      case '(':
+      case ')':
+      case '[':
+      case '{':
+      case '}':
+      case ';':
+      case ':':
+      case '=':
+        flags.onerror(it->loc, (llvm::Twine("invalid type parameter '") + data + "'").str(), ERROR);
+        break;
+      default:
+        if (!lwc) flags.onerror(it->loc, "type parameters should be separated by a comma", ERROR);
+        if (std::find(tparams.begin(), tparams.end(), sstring::get(data)) != tparams.end()) flags.onerror(it->loc, (llvm::Twine("redefinition of type parameter '") + data + "'").str(), ERROR);
+        tparams.push_back(sstring::get(data));
+        lwc = false;
+    }
+  }
+  flags.onerror((it - 1)->loc, "unterminated type parameter list", ERROR);
+  return tparams;
+}
 std::pair<sstring, span<token>::iterator> parse_type(span<token> code, flags_t flags, std::string_view exit_chars) {
   auto it = code.begin(), end = code.end();
   (void)flags;
@@ -87,9 +131,38 @@ std::pair<sstring, span<token>::iterator> parse_type(span<token> code, flags_t f
         else name.push_back('.');
         lwp = 1;
         break;
+      case '[':
+        if (tok.size() == 1 && lwp == 0) {
+          // slices, T[], and arrays, T[N]
+          if (it + 1 != end && it[1].data == "]") {
+            name += "[]";
+            ++it;
+            break;
+          }
+          if (end - it > 2 && it[1].data.front() == '0' && it[2].data == "]") {
+            std::vector<uint64_t> words((it[1].data.size() - 1) / 8);
+            std::memcpy(words.data(), it[1].data.data() + 1, it[1].data.size() - 1);
+            name += '[';
+            name += words.empty() ? "0" : std::to_string(llvm::APInt(words.size() * 64, words).getLimitedValue());
+            name += ']';
+            it += 2;
+            break;
+          }
+          // type arguments, like soa[T]
+          auto [arg, it2] = parse_type({it + 1, end}, flags, "]");
+          if (it2 == end) {
+            flags.onerror(it->loc, "unmatched opening bracket in type name", ERROR);
+            return {sstring::get(""), it2};
+          }
+          if (arg.empty()) return {sstring::get(""), it2};
+          name += '[';
+          name += arg;
+          name += ']';
+          it = it2;
+          break;
+        }
       case '(':
       case ')':
-      case '[':
       case ']':
       case '{':
       case '}':
@@ -111,6 +184,7 @@ std::pair<sstring, span<token>::iterator> parse_type(span<token> code, flags_t f
       case '&':
       case '*':
       case '^':
+      case '?':
         if (tok.size() > 1 && tok[1] != tok.front()) {
           flags.onerror(it->loc, (llvm::Twine("invalid character '") + tok + "' in type name").str(), ERROR);
           return {sstring::get(""), it};
@@ -149,6 +223,7 @@ std::pair<sstring, span<token>::iterator> parse_type(span<token> code, flags_t f
             case '&':
             case '*':
             case '^':
+            case '?':
               if (tok.size() > 1 && tok[1] != tok.front()) {
                 flags.onerror(it->loc, (llvm::Twine("invalid character '") + tok + "' in type name").str(), ERROR);
                 return {sstring::get(""), it};
@@ -250,6 +325,15 @@ AST parse_groups(span<token> code, flags_t flags) {
   }
 }
 AST parse_calls(span<token> code, flags_t flags) {
+  // fields of calls and subscripts, like f().x or xs[i].x, dotted names without them are variable paths
+  for (auto it = code.end(); it - code.begin() > 2 && (it - 2)->data == "." && (std::isalpha((unsigned char)(it - 1)->data.front()) || (it - 1)->data.front() == '_');) {
+    it -= 2;
+    auto c = (it - 1)->data.front();
+    if (c != ')' && c != ']') continue;
+    auto out = parse_calls({code.begin(), it}, flags);
+    for (; it != code.end(); it += 2) out = AST::create<ast::member_ast>(it->loc, std::move(out), sstring::get((it + 1)->data));
+    return out;
+  }
   switch (code.back().data.front()) {
     case ')': {
       auto it = code.end() - 1, end = code.begin() - 1;
@@ -309,11 +393,11 @@ AST parse_calls(span<token> code, flags_t flags) {
   }
 }
 AST parse_postfix(span<token> code, flags_t flags) {
-  for (auto op : post_ops) if (code.back().data == op) return AST::create<ast::unop_ast>(code.back().loc, sstring::get((llvm::Twine("p") + op).str()), parse_postfix(code.subspan(0, code.size() - 1), flags));
+  for (auto [str, op] : post_ops) if (code.back().data == str) return AST::create<ast::unop_ast>(code.back().loc, op, parse_postfix(code.subspan(0, code.size() - 1), flags));
   return parse_calls(code, flags);
 }
 AST parse_prefix(span<token> code, flags_t flags) {
-  for (auto op : pre_ops) if (code.front().data == op) return AST::create<ast::unop_ast>(code.front().loc, sstring::get(op), parse_prefix(code.subspan(1), flags));
+  for (auto [str, op] : pre_ops) if (code.front().data == str) return AST::create<ast::unop_ast>(code.front().loc, op, parse_prefix(code.subspan(1), flags));
   return parse_postfix(code, flags);
 }
 AST parse_cast(span<token> code, flags_t flags) {
@@ -479,7 +563,7 @@ AST parse_ltr_infix(span<token> code, flags_t flags, binary_operator const* star
               lhs = parse_ltr_infix({code.begin(), it}, flags, ptr);
               rhs = parse_ltr_infix({it + 1, code.end()}, flags, start);
             }
-            return AST::create<ast::binop_ast>(it->loc, sstring::get(tok), std::move(lhs), std::move(rhs));
+            return AST::create<ast::binop_ast>(it->loc, op.id, std::move(lhs), std::move(rhs));
           }
         }
     }
@@ -574,7 +658,7 @@ AST parse_rtl_infix(span<token> code, flags_t flags, binary_operator const* star
               lhs = parse_ltr_infix({code.begin(), it}, flags, start);
               rhs = parse_ltr_infix({it + 1, code.end()}, flags, ptr);
             }
-            return AST::create<ast::binop_ast>(it->loc, sstring::get(tok), std::move(lhs), std::move(rhs));
+            return AST::create<ast::binop_ast>(it->loc, op.id, std::move(lhs), std::move(rhs));
           }
         }
     }
@@ -587,8 +671,7 @@ AST parse_infix(span<token> code, flags_t flags, binary_operator const* ptr = &b
   if (ptr->rtl) return parse_rtl_infix(code, flags, ptr);
   else return parse_ltr_infix(code, flags, ptr);
 }
-std::pair<AST, span<token>::iterator> parse_expr(span<token> code, flags_t flags, std::string_view exit_chars) {
-  if (code.empty()) return {AST::create<ast::null_ast>(nullloc), code.end()};
+span<token>::iterator skip_expr(span<token> code, std::string_view exit_chars = ";") {
   auto it = code.begin(), end = code.end();
   std::size_t paren = 0, brack = 0, brace = 0;
   auto nc = [exit_chars](char c) {return exit_chars.find(c) == std::string::npos;};
@@ -602,9 +685,134 @@ std::pair<AST, span<token>::iterator> parse_expr(span<token> code, flags_t flags
       case '}': --brace; break;
     }
   }
+  return it;
+}
+std::pair<AST, span<token>::iterator> parse_expr(span<token> code, flags_t flags, std::string_view exit_chars) {
+  if (code.empty()) return {AST::create<ast::null_ast>(nullloc), code.end()};
+  auto it = skip_expr(code, exit_chars);
   if (code.begin() == it) return {AST::create<ast::null_ast>(code.front().loc), it + 1};
   return {parse_infix({code.begin(), it}, flags, &bin_ops[2]), it};
 }
+// code starts at the struct keyword, the returned iterator points to the closing brace
+// local structs can't have dotted names
+std::pair<AST, span<token>::iterator> parse_struct(span<token> code, flags_t flags, std::vector<std::string>&& annotations, bool local) {
+  auto it = code.begin(), end = code.end();
+  auto start = it->loc;
+  std::string name;
+  uint8_t lwp = 2; // last was period; 0=false, 1=true, 2=start
+  while (++it != end && it->data != "{") {
+    std::string_view tok = it->data;
+    switch (tok.front()) {
+      case '.':
+        if (local) flags.onerror(it->loc, "struct paths are not allowed in local structs", ERROR);
+        else if (lwp == 1) flags.onerror(it->loc, "struct name cannot contain consecutive periods", ERROR);
+        else name.push_back('.');
+        lwp = 1;
+        break;
+      case '"':
+      case '\'':
+      case '0':
+      case '1':
+      case '(':
+      case ')':
+      case '[':
+      case ']':
+      case '}':
+      case ';':
+      case ':':
+      case ',':
+      case '*':
+      case '/':
+      case '%':
+      case '!':
+      case '~':
+      case '+':
+      case '-':
+      case '&':
+      case '|':
+      case '^':
+      case '<':
+      case '>':
+      case '=':
+        flags.onerror(it->loc, (llvm::Twine("invalid character '") + tok + "' in struct name").str(), ERROR);
+        while (it != end && it->data != "{") ++it;
+        goto NAME_END;
+      default:
+        if (lwp == 0) {
+          flags.onerror(it->loc, "struct name cannot contain consecutive identifiers, did you forget a period?", ERROR);
+          if (!local) name.push_back('.');
+        }
+        lwp = 0;
+        name += tok;
+    }
+  }
+  NAME_END:;
+  if (it == end) {
+    flags.onerror((it - 1)->loc, "struct definition must have a body", ERROR);
+    return {AST(nullptr), it - 1};
+  }
+  if (name.empty()) flags.onerror(start, "struct definition must have a name", ERROR);
+  std::vector<ast::structdef_ast::field> fields;
+  while (++it != end && it->data != "}") {
+    std::vector<std::string> field_anns;
+    for (; it != end && it->data.front() == '@'; ++it) field_anns.push_back(std::string(it->data.substr(1)));
+    if (it == end) break;
+    std::string_view field = it->data;
+    switch (field.front()) {
+      case '.':
+      case '"':
+      case '\'':
+      case '0':
+      case '1':
+      case '(':
+      case ')':
+      case '[':
+      case ']':
+      case '{':
+      case ';':
+      case ':':
+      case ',':
+      case '*':
+      case '/':
+      case '%':
+      case '!':
+      case '~':
+      case '+':
+      case '-':
+      case '&':
+      case '|':
+      case '^':
+      case '<':
+      case '>':
+      case '=':
+        flags.onerror(it->loc, (llvm::Twine("invalid field name '") + field + "'").str(), ERROR);
+        goto FIELD_SKIP;
+    }
+    if (++it == end || it->data != ":") {
+      flags.onerror((it - 1)->loc, "struct fields must have an explicit type", ERROR);
+      goto FIELD_SKIP;
+    }
+    {
+      auto [type, it2] = parse_type({it + 1, end}, flags, ",}");
+      it = it2;
+      auto ss = sstring::get(field);
+      if (std::find_if(fields.begin(), fields.end(), [ss] (auto const& f) {return f.name == ss;}) != fields.end()) flags.onerror((it - 1)->loc, (llvm::Twine("duplicate field '") + field + "' in struct").str(), ERROR);
+      else fields.push_back({ss, type, std::move(field_anns)});
+    }
+    if (it == end) break;
+    if (it->data == "}") return {AST::create<ast::structdef_ast>(start, sstring::get(name), std::move(fields), std::move(annotations)), it};
+    if (it->data == ",") continue;
+    flags.onerror(it->loc, "invalid character after type in field, did you forget a comma?", ERROR);
+    FIELD_SKIP:
+    while (it != end && it->data != "," && it->data != "}") ++it;
+    if (it == end || it->data == "}") break;
+  }
+  if (it == end) {
+    flags.onerror((it - 1)->loc, "unterminated struct definition", ERROR);
+    --it;
+  }
+  return {AST::create<ast::structdef_ast>(start, sstring::get(name), std::move(fields), std::move(annotations)), it};
+}
 std::pair<AST, span<token>::iterator> parse_statement(span<token> code, flags_t flags) {
 #define UNSUPPORTED(TYPE) {flags.onerror(it->loc, TYPE " definitions are not currently supported", CRITICAL); return {AST(nullptr), code.begin() + 1};}
   if (code.empty()) return {AST::create<ast::null_ast>(nullloc), code.end()};
@@ -722,7 +930,10 @@ std::pair<AST, span<token>::iterator> parse_statement(span<token> code, flags_t
       else goto ST_DEFAULT;
       break;
     case 's':
-      if (tok == "struct") {annotations.clear(); UNSUPPORTED("struct")}
+      if (tok == "struct") {
+        auto [ast, it2] = parse_struct({it, end}, flags, std::move(annotations), true);
+        return {std::move(ast), it2 + 1};
+      }
       else goto ST_DEFAULT;
       break;
     case 'f':
@@ -762,6 +973,12 @@ std::pair<AST, span<token>::iterator> parse_statement(span<token> code, flags_t
             to_skip = true;
             break;
         }
+        std::vector<sstring> tparams;
+        if ((it + 1)->data.front() == '[') {
+          ++it;
+          tparams = parse_tparams(it, end, flags);
+          if (it == end) return {AST(nullptr), it};
+        }
         switch ((++it)->data.front()) {
           case '(': break;
           case '.':
@@ -866,12 +1083,12 @@ std::pair<AST, span<token>::iterator> parse_statement(span<token> code, flags_t
           }
           if (it->data != "=") {
             flags.onerror(it->loc, "function must have a body", ERROR);
-            return {AST::create<ast::fndef_ast>(start, sstring::get(name), return_type, std::move(params), AST(nullptr), std::move(annotations)), it};
+            return {AST::create<ast::fndef_ast>(start, sstring::get(name), return_type, std::move(params), AST(nullptr), std::move(annotations), std::move(tparams)), it};
           }
           else {
             auto [ast, i] = parse_expr({it + 1, end}, flags);
             it = i;
-            return {AST::create<ast::fndef_ast>(start, sstring::get(name), return_type, std::move(params), std::move(ast), std::move(annotations)), it};
+            return {AST::create<ast::fndef_ast>(start, sstring::get(name), return_type, std::move(params), std::move(ast), std::move(annotations), std::move(tparams)), it};
           }
         }
       }
@@ -1150,14 +1367,19 @@ std::pair<std::vector<AST>, span<token>::iterator> parse_tl(span<token> code, fl
         else goto TL_DEFAULT;
         break;
       case 's':
-        if (tok == "struct") {annotations.clear(); UNSUPPORTED("struct")}
+        if (tok == "struct") {
+          auto [ast, it2] = parse_struct({it, end}, flags, std::exchange(annotations, {}), false);
+          if (ast) tl_nodes.push_back(std::move(ast));
+          it = it2;
+        }
         else goto TL_DEFAULT;
         break;
       case 'f':
         if (tok == "fn") {
           std::string name;
           uint8_t lwp = 2; // last was period; 0=false, 1=true, 2=start
-          bool graceful;
+          bool graceful = false;
+          std::vector<sstring> tparams;
           auto start = it->loc;
           while (++it < end) {
             std::string_view tok = it->data;
@@ -1173,8 +1395,19 @@ std::pair<std::vector<AST>, span<token>::iterator> parse_tl(span<token> code, fl
                 else name.push_back('.');
                 lwp = 1;
                 break;
-              case ')':
               case '[':
+                if (lwp != 0) {
+                  flags.onerror(it->loc, "type parameters must follow a function name", ERROR);
+                  goto FNDEF_END;
+                }
+                tparams = parse_tparams(it, end, flags);
+                if (it == end || (++it)->data.front() != '(') {
+                  flags.onerror((it - 1)->loc, "expected parameter list after type parameters", ERROR);
+                  goto FNDEF_END;
+                }
+                graceful = true;
+                goto FNDEF_END;
+              case ')':
               case ']':
               case '{':
               case '}':
@@ -1288,10 +1521,14 @@ std::pair<std::vector<AST>, span<token>::iterator> parse_tl(span<token> code, fl
               it = i;
             }
             if (it->data != "=") flags.onerror(it->loc, "function must have a body", ERROR);
+            else if (auto body_end = skip_expr({it + 1, end}); flags.lazy_bodies && body_end != it + 1) {
+              tl_nodes.push_back(AST::create<ast::fndef_ast>(start, sstring::get(name), return_type, std::move(params), span<token>{it + 1, body_end}, flags, std::exchange(annotations, {}), std::move(tparams)));
+              it = body_end;
+            }
             else {
               auto [ast, i] = parse_expr({it + 1, end}, flags);
               it = i;
-              tl_nodes.push_back(AST::create<ast::fndef_ast>(start, sstring::get(name), return_type, std::move(params), std::move(ast), std::exchange(annotations, {})));
+              tl_nodes.push_back(AST::create<ast::fndef_ast>(start, sstring::get(name), return_type, std::move(params), std::move(ast), std::exchange(annotations, {}), std::move(tparams)));
             }
           }
         }
@@ -1401,12 +1638,186 @@ std::pair<std::vector<AST>, span<token>::iterator> parse_tl(span<token> code, fl
   }
   return {std::move(tl_nodes), code.end()};
 }
+// split the token stream at top-level statement boundaries, only looking at brackets
+std::vector<span<token>> split_tl(span<token> code) {
+  std::vector<span<token>> chunks;
+  auto start = code.begin(), end = code.end();
+  std::size_t depth = 0;
+  bool is_module = false, first = true;
+  for (auto it = code.begin(); it != end; ++it) {
+    std::string_view tok = it->data;
+    if (first) {
+      if (tok.front() == '@') continue;
+      is_module = tok == "module" || tok == "struct";
+      first = false;
+    }
+    switch (tok.front()) {
+      case '(':
+      case '[':
+      case '{':
+        ++depth;
+        break;
+      case ')':
+      case ']':
+        if (depth) --depth;
+        break;
+      case '}':
+        if (!depth) { // stray closing brace, let the sequential parser report it
+          chunks.emplace_back(start, end);
+          return chunks;
+        }
+        if (--depth || !is_module) break;
+      case ';':
+        if (depth) break;
+        chunks.emplace_back(start, it + 1);
+        start = it + 1;
+        first = true;
+        break;
+    }
+  }
+  if (start != end) chunks.emplace_back(start, end);
+  return chunks;
+}
+AST const& ast::fndef_ast::get_body() const {
+  if (!body_parsed()) body = parse_expr(body_toks, body_flags).first;
+  return body;
+}
+// lazy bodies parsed on a worker thread still refer to its buffered error handler
+void rebind_lazy(std::vector<AST> const& asts, error_handler onerror) {
+  for (auto const& ast : asts) {
+    if (auto ptr = ast.dyn_cast<ast::fndef_ast>()) ptr->body_flags.onerror = onerror;
+    else if (auto ptr = ast.dyn_cast<ast::module_ast>()) rebind_lazy(ptr->insts, onerror);
+  }
+}
+struct buffered_handler {
+  struct diagnostic {
+    location loc;
+    std::string msg;
+    severity sev;
+  };
+  std::vector<diagnostic> diags;
+  void operator()(location loc, std::string_view msg, severity sev) {diags.push_back({loc, std::string(msg), sev});}
+};
+// hash of a chunk's tokens, with lines relative to its first token so that a chunk moved by an edit still matches
+std::size_t chunk_hash(span<token> chunk) {
+  auto first = chunk.front().loc;
+  std::size_t out = hash_combine(std::hash<std::string_view>{}(first.file), first.col);
+  for (auto const& tok : chunk) {
+    out = hash_combine(out, std::hash<std::string_view>{}(tok.data));
+    out = hash_combine(out, tok.loc.line - first.line);
+    out = hash_combine(out, tok.loc.col);
+  }
+  return out;
+}
+constexpr std::size_t min_parallel_chunks = 64;
+// parse the given chunks, returns false if a chunk had an unmatched closing brace
+bool parse_chunks(span<span<token> const> chunks, std::vector<std::vector<AST>>& results, flags_t flags) {
+  results.resize(chunks.size());
+  std::size_t nthreads = flags.parse_threads ? flags.parse_threads : std::thread::hardware_concurrency();
+  if (nthreads < 2 || chunks.size() < min_parallel_chunks) {
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+      auto end = chunks[i].end();
+      std::tie(results[i], end) = parse_tl(chunks[i], flags);
+      if (end != chunks[i].end()) {
+        flags.onerror(end->loc, "unexpected closing brace", ERROR);
+        return false;
+      }
+    }
+    return true;
+  }
+  nthreads = std::min(nthreads, chunks.size() / (min_parallel_chunks / 4));
+  std::vector<buffered_handler> handlers(chunks.size());
+  std::vector<span<token>::iterator> ends(chunks.size());
+  std::atomic_size_t next = 0;
+  auto worker = [&] {
+    for (std::size_t idx; (idx = next.fetch_add(1, std::memory_order_relaxed)) < chunks.size();) {
+      auto f = flags;
+      f.onerror = handlers[idx];
+      std::tie(results[idx], ends[idx]) = parse_tl(chunks[idx], f);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(nthreads - 1);
+  for (std::size_t i = 1; i < nthreads; ++i) threads.emplace_back(worker);
+  worker();
+  for (auto& t : threads) t.join();
+  for (std::size_t i = 0; i < chunks.size(); ++i) { // diagnostics are replayed in source order so the output doesn't depend on scheduling
+    for (auto const& d : handlers[i].diags) flags.onerror(d.loc, d.msg, d.sev);
+    if (ends[i] != chunks[i].end()) {
+      flags.onerror(ends[i]->loc, "unexpected closing brace", ERROR);
+      return false;
+    }
+    if (flags.lazy_bodies) rebind_lazy(results[i], flags.onerror);
+  }
+  return true;
+}
 AST cobalt::parse(span<token> code, flags_t flags) {
   if (code.empty()) return nullptr;
-  auto [asts, end] = parse_tl(code, flags);
-  if (end != code.end()) {
-    flags.onerror(end->loc, "unexpected closing brace", ERROR);
-    return nullptr;
+  auto chunks = split_tl(code);
+  std::vector<std::vector<AST>> results;
+  if (!parse_chunks(chunks, results, flags)) return nullptr;
+  std::vector<AST> asts;
+  std::vector<ast::top_level_ast::chunk_info> info;
+  info.reserve(chunks.size());
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    info.push_back({chunk_hash(chunks[i]), results[i].size(), chunks[i].front().loc.line, chunks[i]});
+    std::move(results[i].begin(), results[i].end(), std::back_inserter(asts));
+  }
+  auto ast = AST::create<ast::top_level_ast>(code.front().loc, std::move(asts));
+  ast.cast<ast::top_level_ast>()->chunks = std::move(info);
+  return ast;
+}
+// move a reused subtree to its position in the new token stream, unparsed bodies are pointed at the new tokens
+void relocate(ast::ast_base& ast, long lines, token const* old_base, token* new_base, flags_t const& flags) {
+  ast.loc.line += lines;
+  if (auto n = ast::ast_cast<ast::fndef_ast>(&ast); n && !n->body_parsed()) {
+    n->body_toks = {new_base + (n->body_toks.data() - old_base), n->body_toks.size()};
+    n->body_flags = flags;
+  }
+  else ast::for_each_child(ast, [&] (AST& child) {if (child) relocate(*child.get(), lines, old_base, new_base, flags);});
+}
+AST cobalt::reparse(AST&& old, span<token> code, flags_t flags) {
+  auto tl = old.dyn_cast<ast::top_level_ast>();
+  if (!tl || tl->chunks.empty() || code.empty()) return parse(code, flags);
+  auto chunks = split_tl(code);
+  std::unordered_map<std::size_t, std::vector<std::size_t>> old_chunks; // hash to indices, in reverse order
+  std::vector<std::size_t> offsets(tl->chunks.size() + 1);
+  for (std::size_t i = 0; i < tl->chunks.size(); ++i) offsets[i + 1] = offsets[i] + tl->chunks[i].count;
+  for (std::size_t i = tl->chunks.size(); i--;) old_chunks[tl->chunks[i].hash].push_back(i);
+  std::vector<ast::top_level_ast::chunk_info> info(chunks.size());
+  std::vector<std::size_t> reused(chunks.size(), -1);
+  std::vector<span<token>> changed;
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    auto hash = chunk_hash(chunks[i]);
+    info[i] = {hash, 0, chunks[i].front().loc.line, chunks[i]};
+    auto it = old_chunks.find(hash);
+    if (it == old_chunks.end() || it->second.empty() || !std::equal(chunks[i].begin(), chunks[i].end(), tl->chunks[it->second.back()].toks.begin(), tl->chunks[it->second.back()].toks.end(), [] (token const& l, token const& r) {return l.data == r.data;})) changed.push_back(chunks[i]);
+    else {
+      reused[i] = it->second.back();
+      it->second.pop_back();
+    }
+  }
+  std::vector<std::vector<AST>> results;
+  if (!parse_chunks(changed, results, flags)) return nullptr;
+  std::vector<AST> asts;
+  for (std::size_t i = 0, next = 0; i < chunks.size(); ++i) {
+    if (reused[i] == std::size_t(-1)) {
+      auto& res = results[next++];
+      info[i].count = res.size();
+      std::move(res.begin(), res.end(), std::back_inserter(asts));
+    }
+    else {
+      auto const& old_info = tl->chunks[reused[i]];
+      info[i].count = old_info.count;
+      long lines = long(info[i].line) - long(old_info.line);
+      for (std::size_t j = offsets[reused[i]]; j < offsets[reused[i] + 1]; ++j) {
+        if (tl->insts[j]) relocate(*tl->insts[j].get(), lines, old_info.toks.data(), chunks[i].data(), flags);
+        asts.push_back(std::move(tl->insts[j]));
+      }
+    }
   }
-  return AST::create<ast::top_level_ast>(code.front().loc, std::move(asts));
+  tl->loc = code.front().loc;
+  tl->insts = std::move(asts);
+  tl->chunks = std::move(info);
+  return std::move(old);
 }
@@ -54,12 +54,12 @@ void cobalt::ast::cast_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefix
   print_node(os, prefix, val, true);
 }
 void cobalt::ast::binop_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const {
-  print_self(os, llvm::Twine("op: ") + op);
+  print_self(os, llvm::Twine("op: ") + op_name(op));
   print_node(os, prefix, lhs, false);
   print_node(os, prefix, rhs, true);
 }
 void cobalt::ast::unop_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const {
-  print_self(os, llvm::Twine("op: ") + op);
+  print_self(os, llvm::Twine("op: ") + op_name(op));
   print_node(os, prefix, val, true);
 }
 void cobalt::ast::call_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const {
@@ -76,6 +76,10 @@ void cobalt::ast::subscr_ast::print_impl(llvm::raw_ostream& os, llvm::Twine pref
   auto last = &args.back();
   for (auto const& ast : args) print_node(os, prefix, ast, &ast == last);
 }
+void cobalt::ast::member_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const {
+  print_self(os, llvm::Twine("member: ") + field);
+  print_node(os, prefix, val, true);
+}
 void cobalt::ast::fndef_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const {
   auto sz = args.size();
   if (sz) {
@@ -83,8 +87,10 @@ void cobalt::ast::fndef_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefi
     for (auto const& [param, type] : args) os << prefix << "├── " << param << ": " << type << '\n';
   }
   else os << llvm::Twine("fndef: ") + name + ", no params\n";
+  for (auto const& tp : tparams) os << prefix << "├── type param: " << tp << '\n';
   for (auto const& ann : annotations) os << prefix << "├── @" << ann << '\n';
-  print_node(os, prefix, body, true);
+  if (body_parsed()) print_node(os, prefix, body, true);
+  else os << prefix << "└── (" << body_toks.size() << " unparsed tokens)\n";
 }
 // keyvals.hpp
 void cobalt::ast::null_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const {
@@ -135,3 +141,13 @@ void cobalt::ast::mutdef_ast::print_impl(llvm::raw_ostream& os, llvm::Twine pref
 void cobalt::ast::varget_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const {
   print_self(os, llvm::Twine("varget: ") + name);
 }
+// typedefs.hpp
+void cobalt::ast::structdef_ast::print_impl(llvm::raw_ostream& os, llvm::Twine prefix) const {
+  print_self(os, llvm::Twine("structdef: ") + name);
+  for (auto const& ann : annotations) os << prefix << (&ann == &annotations.back() && fields.empty() ? "└── @" : "├── @") << ann << '\n';
+  for (auto const& f : fields) {
+    os << prefix << (&f == &fields.back() ? "└── " : "├── ");
+    for (auto const& ann : f.annotations) os << '@' << ann << ' ';
+    os << f.name << ": " << f.type << '\n';
+  }
+}
@@ -0,0 +1,162 @@
+#include "cobalt/sema.hpp"
+#include "cobalt/ast.hpp"
+#include "cobalt/types.hpp"
+using namespace cobalt;
+namespace {
+  struct annotator : ast::visitor<annotator> {
+    base_context& ctx;
+    annotator(base_context& ctx) : ctx(ctx) {}
+    template <class T> void set_type(T const& n) {
+      n.cached_type = n.type(ctx);
+      n.annotated = true;
+    }
+    void visit_children(ast::ast_base const& n) {ast::for_each_child(n, *this);}
+    varmap* root() const {
+      varmap* vm = ctx.vars;
+      while (vm->parent) vm = vm->parent;
+      return vm;
+    }
+    // modules are shared with the real scopes, so they're copied before anything is defined in them
+    std::unordered_set<varmap const*> owned;
+    varmap* submodule(varmap* vm, sstring name, bool create) {
+      if (!create) {
+        auto ptr = vm->get(name);
+        return ptr && ptr->index() == 2 ? std::get<2>(*ptr).get() : nullptr;
+      }
+      auto [sym, succ] = vm->emplace(name, std::make_shared<varmap>(vm));
+      if (!succ) {
+        if (sym->index() != 2) return nullptr;
+        if (!owned.contains(std::get<2>(*sym).get())) {
+          auto nvm = std::make_shared<varmap>(vm);
+          nvm->import(std::get<2>(*sym));
+          *sym = nvm;
+        }
+      }
+      auto out = std::get<2>(*sym).get();
+      owned.insert(out);
+      return out;
+    }
+    // find the module a dotted name is defined in and strip the name to its last component
+    varmap* def_scope(std::string_view& name, bool create = true) {
+      varmap* vm = name.front() == '.' ? root() : ctx.vars;
+      if (name.front() == '.') name.remove_prefix(1);
+      for (auto idx = name.find('.'); vm && idx != std::string::npos; idx = name.find('.')) {
+        vm = submodule(vm, sstring::get(name.substr(0, idx)), create);
+        name.remove_prefix(idx + 1);
+      }
+      return vm;
+    }
+    template <class T> void visit_node(T const& n) {
+      visit_children(n);
+      set_type(n);
+    }
+    void visit_node(ast::block_ast const& n) {
+      ctx.locals.push_scope();
+      visit_children(n);
+      set_type(n);
+      ctx.locals.pop_scope();
+    }
+    void visit_node(ast::fndef_ast const& n) {
+      // generic bodies are only typed once they're instantiated, in codegen
+      if (!n.tparams.empty()) {
+        auto idx = n.name.rfind('.');
+        ctx.define(sstring::get(idx == std::string::npos ? std::string_view(n.name) : n.name.substr(idx + 1)), typed_value{nullptr, types::generic::get(&n, n.name)});
+        set_type(n);
+        return;
+      }
+      std::vector<type_ptr> args_t(n.args.size());
+      for (std::size_t i = 0; i < n.args.size(); ++i) args_t[i] = ctx.parse_type(n.args[i].second);
+      auto ret = ctx.parse_type(n.ret);
+      if (ret && std::find(args_t.begin(), args_t.end(), nullptr) == args_t.end()) {
+        auto idx = n.name.rfind('.');
+        ctx.define(sstring::get(idx == std::string::npos ? std::string_view(n.name) : n.name.substr(idx + 1)), typed_value{nullptr, types::function::get(ret, std::vector<type_ptr>(args_t))});
+      }
+      if (n.body_parsed()) {
+        ctx.locals.push_scope();
+        for (std::size_t i = 0; i < n.args.size(); ++i) if (!n.args[i].first.empty() && args_t[i]) ctx.locals.insert(n.args[i].first, typed_value{nullptr, args_t[i]});
+        (*this)(n.body);
+        ctx.locals.pop_scope();
+      }
+      set_type(n);
+    }
+    void visit_node(ast::module_ast const& n) {
+      std::string_view name = n.name;
+      auto vm = def_scope(name);
+      if (vm) vm = submodule(vm, sstring::get(name), true);
+      // the path is tracked the same way as in codegen, so that qualified type names match
+      std::vector<std::string_view> old_path;
+      if (n.name.front() == '.') {
+        old_path = ctx.path;
+        ctx.path = {std::string_view(n.name).substr(1)};
+      }
+      else ctx.path.push_back(n.name);
+      if (vm) {
+        std::swap(ctx.vars, vm);
+        visit_children(n);
+        std::swap(ctx.vars, vm);
+      }
+      else visit_children(n); // bad module name, the contents are still annotated
+      if (n.name.front() == '.') std::swap(ctx.path, old_path);
+      else ctx.path.pop_back();
+      set_type(n);
+    }
+    void visit_node(ast::structdef_ast const& n) {
+      std::string_view name = n.name;
+      auto vm = def_scope(name);
+      if (auto t = n.struct_type(ctx)) {
+        if (vm == ctx.vars) ctx.define(sstring::get(name), t);
+        else if (vm) vm->insert(sstring::get(name), t);
+      }
+      set_type(n);
+    }
+    void visit_node(ast::import_ast const& n) {
+      std::string_view path = n.path;
+      auto idx = path.rfind('.');
+      if (path.ends_with('*')) {
+        auto ptr = idx == std::string::npos ? nullptr : ctx.resolve(path.substr(0, idx));
+        if (ptr && ptr->index() == 2) {
+          if (ctx.locals.depth()) ctx.locals.import(std::get<2>(*ptr));
+          else ctx.vars->import(std::get<2>(*ptr));
+        }
+      }
+      else if (auto ptr = ctx.resolve(path)) {
+        auto ss = sstring::get(idx == std::string::npos ? path : path.substr(idx + 1));
+        if (ctx.locals.depth()) ctx.locals.insert(ss, *ptr);
+        else {
+          auto [sym, succ] = ctx.vars->emplace(ss, *ptr);
+          if (!succ && ptr->index() == 2 && sym->index() == 2) std::get<2>(*sym)->import(std::get<2>(*ptr));
+        }
+      }
+      set_type(n);
+    }
+    template <class T> void visit_def(T const& n) {
+      visit_children(n);
+      set_type(n);
+      std::string_view name = n.name;
+      auto vm = def_scope(name);
+      if (!vm || !n.cached_type) return;
+      auto t = n.cached_type;
+      if (t->kind == types::type_base::INTEGER && !static_cast<types::integer const*>(t)->nbits) t = types::integer::get(64);
+      if (vm == ctx.vars) ctx.define(sstring::get(name), typed_value{nullptr, t});
+      else vm->insert(sstring::get(name), typed_value{nullptr, t});
+    }
+    void visit_node(ast::vardef_ast const& n) {visit_def(n);}
+    void visit_node(ast::mutdef_ast const& n) {visit_def(n);}
+  };
+}
+void cobalt::annotate(AST const& ast, base_context& ctx) {
+  // definitions go into a scratch scope so that codegen can still insert the real values
+  // the real scopes are imported without taking ownership, since they outlive the pass
+  varmap scratch;
+  for (auto vm = ctx.vars; vm; vm = vm->parent) scratch.import(std::shared_ptr<varmap>(std::shared_ptr<varmap>(), vm));
+  symbol_table locals;
+  std::swap(ctx.locals, locals);
+  auto old = ctx.vars;
+  ctx.vars = &scratch;
+  annotator{ctx}(ast);
+  ctx.vars = old;
+  std::swap(ctx.locals, locals);
+  // the scratch modules are gone, and their addresses could be reused
+  ctx.resolve_cache.clear();
+  ctx.scoped_type_cache.clear();
+}
@@ -0,0 +1,388 @@
+#include "cobalt/serialize.hpp"
+#include "cobalt/ast.hpp"
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/MemoryBuffer.h>
+using namespace cobalt;
+// file layout: magic, version, string table (count, then length-prefixed strings), root node
+// nodes are written in preorder as a kind byte, the location, and then the node's fields
+// all integers are ULEB128-encoded, and strings are indices into the string table
+// operators are stored by spelling, so the format doesn't depend on the order of op_t
+namespace {
+  constexpr uint8_t null_node = 0xff;
+  struct writer {
+    std::string buf;
+    llvm::raw_string_ostream os{buf};
+    llvm::StringMap<std::size_t> str_ids;
+    std::vector<std::string_view> strs;
+    void num(uint64_t val) {llvm::encodeULEB128(val, os);}
+    void str(std::string_view val) {
+      auto [it, inserted] = str_ids.try_emplace(val, strs.size());
+      if (inserted) strs.push_back(it->first());
+      num(it->second);
+    }
+    void strs_of(std::vector<std::string> const& vals) {
+      num(vals.size());
+      for (auto const& val : vals) str(val);
+    }
+    void nodes(std::vector<AST> const& asts) {
+      num(asts.size());
+      for (auto const& ast : asts) node(ast);
+    }
+    void node(AST const& ast) {
+      auto ptr = ast.get();
+      if (!ptr) {
+        os << char(null_node);
+        return;
+      }
+      os << char(ptr->kind);
+      str(ptr->loc.file);
+      num(ptr->loc.line);
+      num(ptr->loc.col);
+      switch (ptr->kind) {
+        using namespace ast;
+        case ast_base::kind_t::TOP_LEVEL: nodes(ast.cast<top_level_ast>()->insts); break;
+        case ast_base::kind_t::GROUP: nodes(ast.cast<group_ast>()->insts); break;
+        case ast_base::kind_t::BLOCK: nodes(ast.cast<block_ast>()->insts); break;
+        case ast_base::kind_t::IF: {
+          auto n = ast.cast<if_ast>();
+          node(n->cond);
+          node(n->if_true);
+          node(n->if_false);
+        } break;
+        case ast_base::kind_t::WHILE: {
+          auto n = ast.cast<while_ast>();
+          node(n->cond);
+          node(n->body);
+        } break;
+        case ast_base::kind_t::FOR: {
+          auto n = ast.cast<for_ast>();
+          str(n->elem_name);
+          node(n->cond);
+          node(n->body);
+        } break;
+        case ast_base::kind_t::BINOP: {
+          auto n = ast.cast<binop_ast>();
+          str(op_name(n->op));
+          node(n->lhs);
+          node(n->rhs);
+        } break;
+        case ast_base::kind_t::UNOP: {
+          auto n = ast.cast<unop_ast>();
+          str(op_name(n->op));
+          node(n->val);
+        } break;
+        case ast_base::kind_t::CAST: {
+          auto n = ast.cast<cast_ast>();
+          str(n->target);
+          node(n->val);
+        } break;
+        case ast_base::kind_t::CALL: {
+          auto n = ast.cast<call_ast>();
+          node(n->val);
+          nodes(n->args);
+        } break;
+        case ast_base::kind_t::SUBSCR: {
+          auto n = ast.cast<subscr_ast>();
+          node(n->val);
+          nodes(n->args);
+        } break;
+        case ast_base::kind_t::MEMBER: {
+          auto n = ast.cast<member_ast>();
+          node(n->val);
+          str(n->field);
+        } break;
+        case ast_base::kind_t::FNDEF: {
+          auto n = ast.cast<fndef_ast>();
+          str(n->name);
+          str(n->ret);
+          num(n->args.size());
+          for (auto [name, type] : n->args) {
+            str(name);
+            str(type);
+          }
+          node(n->get_body());
+          strs_of(n->annotations);
+          num(n->tparams.size());
+          for (auto tp : n->tparams) str(tp);
+        } break;
+        case ast_base::kind_t::NULLVAL: break;
+        case ast_base::kind_t::INTEGER: {
+          auto n = ast.cast<integer_ast>();
+          str(n->suffix);
+          num(n->val.getBitWidth());
+          for (unsigned i = 0; i < n->val.getNumWords(); ++i) num(n->val.getRawData()[i]);
+        } break;
+        case ast_base::kind_t::FLOAT: {
+          auto n = ast.cast<float_ast>();
+          str(n->suffix);
+          char bytes[sizeof(double)];
+          std::memcpy(bytes, &n->val, sizeof(double));
+          os.write(bytes, sizeof(double));
+        } break;
+        case ast_base::kind_t::STRING: {
+          auto n = ast.cast<string_ast>();
+          str(n->suffix);
+          str(n->val);
+        } break;
+        case ast_base::kind_t::CHAR: {
+          auto n = ast.cast<char_ast>();
+          str(n->suffix);
+          str(n->val);
+        } break;
+        case ast_base::kind_t::MODULE: {
+          auto n = ast.cast<module_ast>();
+          str(n->name);
+          nodes(n->insts);
+        } break;
+        case ast_base::kind_t::IMPORT: str(ast.cast<import_ast>()->path); break;
+        case ast_base::kind_t::VARDEF: {
+          auto n = ast.cast<vardef_ast>();
+          str(n->name);
+          node(n->val);
+          num(n->global);
+          strs_of(n->annotations);
+        } break;
+        case ast_base::kind_t::MUTDEF: {
+          auto n = ast.cast<mutdef_ast>();
+          str(n->name);
+          node(n->val);
+          num(n->global);
+          strs_of(n->annotations);
+        } break;
+        case ast_base::kind_t::VARGET: str(ast.cast<varget_ast>()->name); break;
+        case ast_base::kind_t::STRUCTDEF: {
+          auto n = ast.cast<structdef_ast>();
+          str(n->name);
+          num(n->fields.size());
+          for (auto const& f : n->fields) {
+            str(f.name);
+            str(f.type);
+            strs_of(f.annotations);
+          }
+          strs_of(n->annotations);
+        } break;
+      }
+    }
+  };
+  struct reader {
+    uint8_t const* it;
+    uint8_t const* end;
+    std::vector<sstring> strs;
+    bool failed = false;
+    uint64_t num() {
+      unsigned n;
+      const char* err = nullptr;
+      auto val = llvm::decodeULEB128(it, &n, end, &err);
+      if (err) {
+        failed = true;
+        return 0;
+      }
+      it += n;
+      return val;
+    }
+    uint8_t byte() {
+      if (it == end) {
+        failed = true;
+        return null_node;
+      }
+      return *it++;
+    }
+    sstring str() {
+      auto idx = num();
+      if (idx >= strs.size()) {
+        failed = true;
+        return sstring::get("");
+      }
+      return strs[idx];
+    }
+    std::vector<std::string> strs_of() {
+      std::vector<std::string> out;
+      for (auto n = num(); n && !failed; --n) out.emplace_back(str());
+      return out;
+    }
+    std::vector<AST> nodes() {
+      std::vector<AST> out;
+      for (auto n = num(); n && !failed; --n) out.push_back(node());
+      return out;
+    }
+    AST node() {
+      auto kind = byte();
+      if (kind == null_node || failed) return nullptr;
+      location loc{str(), num(), num()};
+      switch (static_cast<ast::ast_base::kind_t>(kind)) {
+        using namespace ast;
+        case ast_base::kind_t::TOP_LEVEL: return AST::create<top_level_ast>(loc, nodes());
+        case ast_base::kind_t::GROUP: return AST::create<group_ast>(loc, nodes());
+        case ast_base::kind_t::BLOCK: return AST::create<block_ast>(loc, nodes());
+        case ast_base::kind_t::IF: {
+          auto cond = node();
+          auto if_true = node();
+          return AST::create<if_ast>(loc, std::move(cond), std::move(if_true), node());
+        }
+        case ast_base::kind_t::WHILE: {
+          auto cond = node();
+          return AST::create<while_ast>(loc, std::move(cond), node());
+        }
+        case ast_base::kind_t::FOR: {
+          auto elem_name = str();
+          auto cond = node();
+          return AST::create<for_ast>(loc, elem_name, std::move(cond), node());
+        }
+        case ast_base::kind_t::BINOP: {
+          auto op = op_id(str());
+          if (!op) failed = true;
+          auto lhs = node();
+          return AST::create<binop_ast>(loc, op, std::move(lhs), node());
+        }
+        case ast_base::kind_t::UNOP: {
+          auto op = op_id(str());
+          if (!op) failed = true;
+          return AST::create<unop_ast>(loc, op, node());
+        }
+        case ast_base::kind_t::CAST: {
+          auto target = str();
+          return AST::create<cast_ast>(loc, target, node());
+        }
+        case ast_base::kind_t::CALL: {
+          auto val = node();
+          return AST::create<call_ast>(loc, std::move(val), nodes());
+        }
+        case ast_base::kind_t::SUBSCR: {
+          auto val = node();
+          return AST::create<subscr_ast>(loc, std::move(val), nodes());
+        }
+        case ast_base::kind_t::MEMBER: {
+          auto val = node();
+          return AST::create<member_ast>(loc, std::move(val), str());
+        }
+        case ast_base::kind_t::FNDEF: {
+          auto name = str();
+          auto ret = str();
+          std::vector<std::pair<sstring, sstring>> args;
+          for (auto n = num(); n && !failed; --n) {
+            auto arg = str();
+            args.emplace_back(arg, str());
+          }
+          auto body = node();
+          auto anns = strs_of();
+          std::vector<sstring> tparams;
+          for (auto n = num(); n && !failed; --n) tparams.push_back(str());
+          return AST::create<fndef_ast>(loc, name, ret, std::move(args), std::move(body), std::move(anns), std::move(tparams));
+        }
+        case ast_base::kind_t::NULLVAL: return AST::create<null_ast>(loc);
+        case ast_base::kind_t::INTEGER: {
+          auto suffix = str();
+          auto bits = num();
+          if (!bits || bits > llvm::IntegerType::MAX_INT_BITS) {
+            failed = true;
+            return nullptr;
+          }
+          std::vector<uint64_t> words((bits + 63) / 64);
+          for (auto& w : words) w = num();
+          return AST::create<integer_ast>(loc, llvm::APInt(bits, words), suffix);
+        }
+        case ast_base::kind_t::FLOAT: {
+          auto suffix = str();
+          if (end - it < (long)sizeof(double)) {
+            failed = true;
+            return nullptr;
+          }
+          double val;
+          std::memcpy(&val, it, sizeof(double));
+          it += sizeof(double);
+          return AST::create<float_ast>(loc, val, suffix);
+        }
+        case ast_base::kind_t::STRING: {
+          auto suffix = str();
+          return AST::create<string_ast>(loc, std::string(str()), suffix);
+        }
+        case ast_base::kind_t::CHAR: {
+          auto suffix = str();
+          return AST::create<char_ast>(loc, std::string(str()), suffix);
+        }
+        case ast_base::kind_t::MODULE: {
+          std::string name(str());
+          return AST::create<module_ast>(loc, std::move(name), nodes());
+        }
+        case ast_base::kind_t::IMPORT: return AST::create<import_ast>(loc, std::string(str()));
+        case ast_base::kind_t::VARDEF: {
+          auto name = str();
+          auto val = node();
+          bool global = num();
+          return AST::create<vardef_ast>(loc, name, std::move(val), global, strs_of());
+        }
+        case ast_base::kind_t::MUTDEF: {
+          auto name = str();
+          auto val = node();
+          bool global = num();
+          return AST::create<mutdef_ast>(loc, name, std::move(val), global, strs_of());
+        }
+        case ast_base::kind_t::VARGET: return AST::create<varget_ast>(loc, str());
+        case ast_base::kind_t::STRUCTDEF: {
+          auto name = str();
+          std::vector<structdef_ast::field> fields;
+          for (auto n = num(); n && !failed; --n) {
+            auto field = str();
+            auto type = str();
+            fields.push_back({field, type, strs_of()});
+          }
+          return AST::create<structdef_ast>(loc, name, std::move(fields), strs_of());
+        }
+        default:
+          failed = true;
+          return nullptr;
+      }
+    }
+  };
+}
+void cobalt::serialize(AST const& ast, llvm::raw_ostream& os) {
+  writer w;
+  w.node(ast);
+  w.os.flush();
+  os << coast_magic << char(coast_version);
+  llvm::encodeULEB128(w.strs.size(), os);
+  for (auto str : w.strs) {
+    llvm::encodeULEB128(str.size(), os);
+    os << str;
+  }
+  os << w.buf;
+}
+AST cobalt::deserialize(std::string_view data, flags_t flags) {
+  if (!data.starts_with(coast_magic) || data.size() == coast_magic.size()) {
+    flags.onerror(nullloc, "invalid AST file", ERROR);
+    return nullptr;
+  }
+  if (uint8_t(data[coast_magic.size()]) != coast_version) {
+    flags.onerror(nullloc, "AST file version " + std::to_string(uint8_t(data[coast_magic.size()])) + " is not supported, expected version " + std::to_string(coast_version), ERROR);
+    return nullptr;
+  }
+  data.remove_prefix(coast_magic.size() + 1);
+  reader r{(uint8_t const*)data.data(), (uint8_t const*)data.data() + data.size()};
+  auto count = r.num();
+  if (count > data.size()) r.failed = true;
+  else r.strs.reserve(count);
+  for (; count && !r.failed; --count) {
+    auto len = r.num();
+    if (len > std::size_t(r.end - r.it)) {
+      r.failed = true;
+      break;
+    }
+    r.strs.push_back(sstring::get(std::string_view{(char const*)r.it, len}));
+    r.it += len;
+  }
+  auto ast = r.node();
+  if (r.failed || r.it != r.end) {
+    flags.onerror(nullloc, "malformed AST file", ERROR);
+    return nullptr;
+  }
+  return ast;
+}
+AST cobalt::load_ast(std::string_view path, flags_t flags) {
+  auto f = llvm::MemoryBuffer::getFile(path, false, false); // mapped for large files
+  if (!f) {
+    flags.onerror(nullloc, "error opening " + std::string(path) + ": " + f.getError().message(), ERROR);
+    return nullptr;
+  }
+  return deserialize({f.get()->getBufferStart(), f.get()->getBufferSize()}, flags);
+}
@@ -476,6 +476,7 @@ template <class I> std::optional<std::string> parse_macro(I& it, I end, macro_ma
       case '~':
       case '|':
       case '!':
+      case '?':
       case '@':
       case '\\':
 #pragma endregion
@@ -1225,6 +1226,7 @@ std::vector<token> cobalt::tokenize(std::string_view code, location loc, flags_t
         case '/':
         case '%':
         case '!':
+        case '?':
         case '~':
           out.push_back({loc, {char(c)}});
           topb = true;
@@ -15,13 +15,13 @@ EXPORT uint64_t CALL __co_fread(void* buffer, uint64_t size, void* stream) {retu
 EXPORT uint64_t CALL __co_fwrite(void* buffer, uint64_t size, void* stream) {return std::fwrite(buffer, size, 1, (std::FILE*)stream);}
 EXPORT optional_int8_t CALL __co_fgetc(void* stream) {
   auto res = std::fgetc((std::FILE*)stream);
-  if (res == EOF) return {false, 0};
-  else return {true, (int8_t)res};
+  if (res == EOF) return optional_int8_t_empty;
+  else return (uint8_t)res;
 }
 EXPORT optional_int8_t CALL __co_fputc(uint8_t ch, void* stream) {
   auto res = std::fputc(ch, (std::FILE*)stream);
-  if (res == EOF) return {false, 0};
-  else return {true, (int8_t)res};
+  if (res == EOF) return optional_int8_t_empty;
+  else return (uint8_t)res;
 }
 EXPORT int64_t CALL __co_ftell(void* stream) {return std::ftell((std::FILE*)stream);}
 EXPORT bool CALL __co_fseek(void* stream, int64_t offset, int8_t origin) {return std::fseek((std::FILE*)stream, offset, origin) == 0;}
\ No newline at end of file
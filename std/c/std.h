@@ -2,8 +2,9 @@
 #define LIBCOSTD_H
 #include "compat.h"
 #include <stdint.h>
-#define DEF_OPTIONAL(T) struct optional_ ## T {bool selector; T value;};
-DEF_OPTIONAL(int8_t)
+// small integer optionals are returned packed in a register: the value is in the low bits, and the byte above it is 1 if it's empty
+#define DEF_OPTIONAL(T, U, N) typedef U optional_ ## T; static const U optional_ ## T ## _empty = (U)1 << N;
+DEF_OPTIONAL(int8_t, uint16_t, 8)
 // allocation
 IMPORT void* CALL __co_alloc(uint64_t size, uint8_t align);
 IMPORT void  CALL __co_free(void* ptr);
@@ -0,0 +1,207 @@
+#ifndef COBALT_TESTS_CODEGEN_HPP
+#define COBALT_TESTS_CODEGEN_HPP
+#include "cobalt/tokenizer.hpp"
+#include "cobalt/parser.hpp"
+#include "cobalt/optimize.hpp"
+#include "cobalt/sema.hpp"
+#include "cobalt/ast.hpp"
+#include <llvm/IR/Instructions.h>
+#include <llvm/Passes/PassBuilder.h>
+namespace tests::codegen {
+  using namespace cobalt;
+  // number of bounds checks left in a function
+  std::size_t count_checks(llvm::Function const* f) {
+    std::size_t n = 0;
+    for (auto const& bb : *f) for (auto const& inst : bb) if (inst.getMetadata(bounds_check_md)) ++n;
+    return n;
+  }
+  // untyped literals are stored as i64, whether they're in globals or locals
+  bool literal_widths() {
+    quiet_handler_t h;
+    flags_t flags = default_flags;
+    flags.onerror = h;
+    auto toks = tokenize(R"(let x = 1;
+mut y = 2;
+fn f(): i64 = {mut w = 3; w};)", sstring::get("<test>"), flags);
+    auto ast = parse({toks.begin(), toks.end()}, flags);
+    compile_context ctx{"<test>", flags};
+    ast(ctx);
+    if (h.errors) return false;
+    auto i64 = llvm::Type::getInt64Ty(*ctx.context);
+    auto x = ctx.module->getNamedGlobal("x"), y = ctx.module->getNamedGlobal("y");
+    auto f = ctx.module->getFunction("f");
+    if (!x || !y || !f || x->getValueType() != i64 || y->getValueType() != i64) return false;
+    for (auto const& inst : f->getEntryBlock()) if (auto a = llvm::dyn_cast<llvm::AllocaInst>(&inst)) return a->getAllocatedType() == i64;
+    return false;
+  }
+  bool bounds_checks() {
+    quiet_handler_t h;
+    flags_t flags = default_flags;
+    flags.onerror = h;
+    auto toks = tokenize(R"(fn masked(xs: i32[8], i: i64): i32 = xs[i & 7];
+fn sliced(xs: i32[], i: i64): i32 = xs[i];
+fn first(xs: i32[], i: i64): i32 = xs[0];)", sstring::get("<test>"), flags);
+    auto ast = parse({toks.begin(), toks.end()}, flags);
+    compile_context ctx{"<test>", flags};
+    ast(ctx);
+    if (h.errors) return false;
+    auto masked = ctx.module->getFunction("masked"), sliced = ctx.module->getFunction("sliced"), first = ctx.module->getFunction("first");
+    return masked && sliced && first && !count_checks(masked) && count_checks(sliced) == 1 && count_checks(first) == 1;
+  }
+  // for (i = 0; i < len; ++i) check(i < len), built by hand since loops aren't lowered yet
+  bool loop_bounds() {
+    llvm::LLVMContext llctx;
+    llvm::Module mod("<test>", llctx);
+    llvm::IRBuilder<> b(llctx);
+    auto i64 = b.getInt64Ty();
+    auto f = llvm::Function::Create(llvm::FunctionType::get(b.getVoidTy(), {i64}, false), llvm::GlobalValue::ExternalLinkage, "loop", mod);
+    auto entry = llvm::BasicBlock::Create(llctx, "entry", f), head = llvm::BasicBlock::Create(llctx, "head", f), body = llvm::BasicBlock::Create(llctx, "body", f), in_bounds = llvm::BasicBlock::Create(llctx, "in_bounds", f), fail = llvm::BasicBlock::Create(llctx, "out_of_bounds", f), exit = llvm::BasicBlock::Create(llctx, "exit", f);
+    auto len = f->getArg(0);
+    b.SetInsertPoint(entry);
+    b.CreateBr(head);
+    b.SetInsertPoint(head);
+    auto i = b.CreatePHI(i64, 2);
+    b.CreateCondBr(b.CreateICmpULT(i, len), body, exit);
+    b.SetInsertPoint(body);
+    auto cmp = llvm::cast<llvm::Instruction>(b.CreateICmpULT(i, len));
+    cmp->setMetadata(bounds_check_md, llvm::MDNode::get(llctx, {}));
+    b.CreateCondBr(cmp, in_bounds, fail);
+    b.SetInsertPoint(fail);
+    b.CreateUnreachable();
+    b.SetInsertPoint(in_bounds);
+    auto next = b.CreateAdd(i, b.getInt64(1));
+    b.CreateBr(head);
+    b.SetInsertPoint(exit);
+    b.CreateRetVoid();
+    i->addIncoming(b.getInt64(0), entry);
+    i->addIncoming(next, in_bounds);
+    elide_bounds_checks(*f);
+    return !count_checks(f) && f->size() == 4;
+  }
+  bool generics() {
+    quiet_handler_t h;
+    flags_t flags = default_flags;
+    flags.onerror = h;
+    auto toks = tokenize(R"(fn id[T](x: T): T = x;
+fn first[T](xs: T[]): T = xs[0];
+fn use(a: i32, b: f64, xs: i16[]): i32 = {
+  let x = id(a);
+  let y = id[i32](a);
+  let z = id(b);
+  let w = first(xs);
+  x
+};)", sstring::get("<test>"), flags);
+    auto ast = parse({toks.begin(), toks.end()}, flags);
+    compile_context ctx{"<test>", flags};
+    annotate(ast, ctx);
+    ast(ctx);
+    if (h.errors) return false;
+    std::size_t ids = 0;
+    for (auto const& f : *ctx.module) if (f.getName().startswith("id[")) ++ids;
+    auto i = ctx.module->getFunction("id[i32]"), d = ctx.module->getFunction("id[f64]"), s = ctx.module->getFunction("first[i16]");
+    if (ids != 2 || !i || !d || !s || !i->hasLinkOnceODRLinkage() || !s->hasLinkOnceODRLinkage()) return false;
+    // arguments that don't match a parameter's pattern can't be deduced
+    auto bad_toks = tokenize("fn first[T](p: T*): T = p[0];\nfn bad(a: i32): i32 = first(a);", sstring::get("<test>"), flags);
+    auto bad = parse({bad_toks.begin(), bad_toks.end()}, flags);
+    compile_context bad_ctx{"<test>", flags};
+    bad(bad_ctx);
+    return h.errors == 1;
+  }
+  bool global_inits() {
+    quiet_handler_t h;
+    flags_t flags = default_flags;
+    flags.onerror = h;
+    auto toks = tokenize(R"(@extern(c) fn ext(x: i64): i64 = 0;
+fn sq(x: i64): i64 = x * x;
+let a = sq(12);
+mut b = sq(a);
+let c = ext(3);
+let d = sq(2);)", sstring::get("<test>"), flags);
+    auto ast = parse({toks.begin(), toks.end()}, flags);
+    compile_context ctx{"<test>", flags};
+    ast(ctx);
+    if (h.errors) return false;
+    auto a = ctx.module->getNamedGlobal("a"), b = ctx.module->getNamedGlobal("b"), c = ctx.module->getNamedGlobal("c"), d = ctx.module->getNamedGlobal("d");
+    if (!a || !b || !c || !d || !ctx.module->getNamedGlobal("llvm.global_ctors")) return false;
+    auto value = [] (llvm::GlobalVariable const* gv) {auto c = llvm::dyn_cast<llvm::ConstantInt>(gv->getInitializer()); return c ? c->getSExtValue() : -1;};
+    // d runs at startup too, since it could observe what c's initializer did
+    return a->isConstant() && value(a) == 144 && !b->isConstant() && value(b) == 20736 && !c->isConstant() && !d->isConstant();
+  }
+  bool demand_codegen() {
+    quiet_handler_t h;
+    flags_t flags = default_flags;
+    flags.onerror = h;
+    flags.demand_codegen = true;
+    auto toks = tokenize(R"(fn leaf(x: i64): i64 = x + 1;
+fn mid(x: i64): i64 = leaf(x) * 2;
+fn unused(x: i64): i64 = mid(x);
+fn sq(x: i64): i64 = x * x;
+@export fn api(x: i64): i64 = x;
+let a = sq(3);
+fn main(): i32 = mid(1);)", sstring::get("<test>"), flags);
+    auto ast = parse({toks.begin(), toks.end()}, flags);
+    compile_context ctx{"<test>", flags};
+    ast(ctx);
+    if (h.errors) return false;
+    auto defined = [&] (llvm::StringRef name) {auto f = ctx.module->getFunction(name); return f && !f->isDeclaration();};
+    auto a = ctx.module->getNamedGlobal("a");
+    // sq is generated for a's initializer, which can then still be run at compile time
+    if (!(
+      defined("main") && defined("mid") && defined("leaf") && defined("api") && defined("sq") && !defined("unused") &&
+      a && a->isConstant() && ctx.deferred.size() == 1
+    )) return false;
+    // deferred bodies can't see what was defined after them, so the same programs compile either way
+    auto errors = [] (bool demand) {
+      quiet_handler_t h;
+      flags_t flags = default_flags;
+      flags.onerror = h;
+      flags.demand_codegen = demand;
+      auto toks = tokenize(R"(fn f(): i64 = g();
+fn g(): i64 = 1;
+fn main(): i32 = f();)", sstring::get("<test>"), flags);
+      auto ast = parse({toks.begin(), toks.end()}, flags);
+      compile_context ctx{"<test>", flags};
+      ast(ctx);
+      return h.errors;
+    };
+    return errors(false) && errors(true) == errors(false);
+  }
+  // each copy of a struct gets its own cold part, so after optimizing, x.b is still what it was constructed with
+  bool cold_copies() {
+    quiet_handler_t h;
+    flags_t flags = default_flags;
+    flags.onerror = h;
+    auto toks = tokenize(R"(struct S {a: i64, @cold b: i64};
+fn f(): i64 = {let x = S(1, 2); mut y = x; y.b = 5; x.b};)", sstring::get("<test>"), flags);
+    auto ast = parse({toks.begin(), toks.end()}, flags);
+    compile_context ctx{"<test>", flags};
+    ast(ctx);
+    if (h.errors) return false;
+    // both cold parts are freed when the block ends
+    auto f = ctx.module->getFunction("f");
+    if (!f || f->isDeclaration()) return false;
+    auto calls = [&] (llvm::StringRef name) {
+      std::size_t n = 0;
+      for (auto const& bb : *f) for (auto const& inst : bb) if (auto call = llvm::dyn_cast<llvm::CallInst>(&inst); call && call->getCalledFunction() && call->getCalledFunction()->getName() == name) ++n;
+      return n;
+    };
+    if (calls("malloc") != 2 || calls("free") != 2) return false;
+    llvm::PassBuilder pb;
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cam;
+    llvm::ModuleAnalysisManager mam;
+    pb.registerModuleAnalyses(mam);
+    pb.registerCGSCCAnalyses(cam);
+    pb.registerFunctionAnalyses(fam);
+    pb.registerLoopAnalyses(lam);
+    pb.crossRegisterProxies(lam, fam, cam, mam);
+    pb.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2).run(*ctx.module, mam);
+    f = ctx.module->getFunction("f");
+    if (!f || f->isDeclaration()) return false;
+    auto ret = llvm::dyn_cast<llvm::ReturnInst>(f->getEntryBlock().getTerminator());
+    auto c = ret ? llvm::dyn_cast<llvm::ConstantInt>(ret->getReturnValue()) : nullptr;
+    return c && c->getSExtValue() == 2;
+  }
+}
+#endif
@@ -1,6 +1,10 @@
 #include "test.hpp"
 #include "tokenizer.hpp"
 #include "parser.hpp"
+#include "serialize.hpp"
+#include "sema.hpp"
+#include "types.hpp"
+#include "codegen.hpp"
 int main() {
   using namespace test::test_builders;
   test::tester {"cobalt", {
@@ -10,9 +14,46 @@ int main() {
       {"macros", mktest(&tests::tokenizer::macros)-finish}
     }},
     {"parser", {
-      {"modules", mktest(&tests::parser::modules)-finish}
+      {"modules", mktest(&tests::parser::modules)-finish},
+      {"hashing", mktest(&tests::parser::hashing)-finish},
+      {"parallel", mktest(&tests::parser::parallel)-finish},
+      {"lazy bodies", mktest(&tests::parser::lazy_bodies)-finish},
+      {"incremental", mktest(&tests::parser::incremental)-finish},
+      {"incremental lazy bodies", mktest(&tests::parser::incremental_lazy)-finish},
+      {"visitor", mktest(&tests::parser::visitor)-finish}
+    }},
+    {"serialization", {
+      {"roundtrip", mktest(&tests::serialize::roundtrip)-finish}
+    }},
+    {"semantics", {
+      {"annotate", mktest(&tests::sema::annotate)-finish},
+      {"scopes", mktest(&tests::sema::scopes)-finish},
+      {"glob imports", mktest(&tests::sema::glob_imports)-finish},
+      {"late glob imports", mktest(&tests::sema::late_imports)-finish},
+      {"qualified names", mktest(&tests::sema::qualified_names)-finish},
+      {"lookup cutoffs", mktest(&tests::sema::cutoffs)-finish},
+      {"constant folding", mktest(&tests::sema::folding)-finish}
+    }},
+    {"types", {
+      {"interning", mktest(&tests::types::interning)-finish},
+      {"names", mktest(&tests::types::names)-finish},
+      {"structs", mktest(&tests::types::structs)-finish},
+      {"hot and cold fields", mktest(&tests::types::hot_cold)-finish},
+      {"structure of arrays", mktest(&tests::types::soa_columns)-finish},
+      {"tuples and variants", mktest(&tests::types::sum_types)-finish},
+      {"optionals", mktest(&tests::types::optionals)-finish},
+      {"vectors", mktest(&tests::types::vectors)-finish},
+      {"arrays and slices", mktest(&tests::types::arrays)-finish}
+    }},
+    {"codegen", {
+      {"literal widths", mktest(&tests::codegen::literal_widths)-finish},
+      {"bounds checks", mktest(&tests::codegen::bounds_checks)-finish},
+      {"loop bounds", mktest(&tests::codegen::loop_bounds)-finish},
+      {"generics", mktest(&tests::codegen::generics)-finish},
+      {"global initializers", mktest(&tests::codegen::global_inits)-finish},
+      {"copied cold fields", mktest(&tests::codegen::cold_copies)-finish},
+      {"demand-driven codegen", mktest(&tests::codegen::demand_codegen)-finish}
     }},
-    {"codegen"},
     {"JIT"}
   }}();
 }
@@ -36,5 +36,164 @@ namespace tests::parser {
     if (h.errors || h.warnings) return false;
     return ast == expected;
   }
+  bool hashing() {
+    quiet_handler_t h;
+    flags.onerror = h;
+    constexpr std::string_view code = R"(module x {
+  fn f(a: i32): i32 = a + 1;
+  let y = f(2);
+})";
+    auto t1 = tokenize(code, sstring::get("<test-1>"), flags);
+    auto t2 = tokenize(code, sstring::get("<test-2>"), flags);
+    auto t3 = tokenize("fn f(a: i32): i32 = a - 1;", sstring::get("<test>"), flags);
+    auto a1 = parse({t1.begin(), t1.end()}, flags), a2 = parse({t2.begin(), t2.end()}, flags), a3 = parse({t3.begin(), t3.end()}, flags);
+    if (h.errors || h.warnings) return false;
+    return a1 == a2 && a1.hash() == a2.hash() && !(a1 == a3) && a1.hash() != a3.hash();
+  }
+  bool parallel() {
+    struct recording_handler {
+      std::vector<std::pair<location, std::string>> diags;
+      void operator()(location loc, std::string_view msg, severity) {diags.emplace_back(loc, std::string(msg));}
+    } seq_h, par_h;
+    std::string code;
+    for (int i = 0; i < 500; ++i) {
+      auto n = std::to_string(i);
+      code += "fn f" + n + "(a: i32): i32 = {let b = a * " + n + "; b + f" + std::to_string(i / 2) + "(a)};\n";
+      if (i % 100 == 50) code += "module m" + n + " {let x = 1; fn g(): i32 = x;}\n= 1;\n";
+    }
+    auto f = flags;
+    f.onerror = seq_h;
+    auto toks = tokenize(code, sstring::get("<test>"), f);
+    f.parse_threads = 1;
+    auto seq = parse({toks.begin(), toks.end()}, f);
+    f.onerror = par_h;
+    f.parse_threads = 4;
+    auto par = parse({toks.begin(), toks.end()}, f);
+    return seq && seq == par && seq_h.diags.size() == 10 && seq_h.diags == par_h.diags;
+  }
+  bool lazy_bodies() {
+    quiet_handler_t h;
+    auto f = flags;
+    f.onerror = h;
+    auto toks = tokenize(R"(fn f(a: i32): i32 = {let b = a * 2; b + 1};
+module m {fn g(): i32 = f(1);})", sstring::get("<test>"), f);
+    auto eager = parse({toks.begin(), toks.end()}, f);
+    f.lazy_bodies = true;
+    auto lazy = parse({toks.begin(), toks.end()}, f);
+    if (h.errors || h.warnings || !lazy) return false;
+    auto const& insts = lazy.cast<ast::top_level_ast>()->insts;
+    if (insts.size() != 2) return false;
+    auto fn = insts[0].dyn_cast<ast::fndef_ast>();
+    if (!fn || fn->body_parsed() || fn->args.size() != 1) return false;
+    return lazy == eager && fn->body_parsed() && fn->get_body().dyn_cast<ast::block_ast>();
+  }
+  bool incremental() {
+    quiet_handler_t h;
+    auto f = flags;
+    f.onerror = h;
+    auto t1 = tokenize(R"(fn f(a: i32): i32 = a;
+fn g(a: i32): i32 = a * 2;
+module m {
+  fn h(): i32 = g(1);
+})", sstring::get("<test>"), f);
+    auto t2 = tokenize(R"(fn f(a: i32): i32 = a;
+fn g(a: i32): i32 = {
+  let b = a;
+  b * 3
+};
+module m {
+  fn h(): i32 = g(1);
+})", sstring::get("<test>"), f);
+    auto ast = parse({t1.begin(), t1.end()}, f);
+    if (!ast) return false;
+    auto old_f = ast.cast<ast::top_level_ast>()->insts[0].get(), old_m = ast.cast<ast::top_level_ast>()->insts[2].get();
+    auto old_g = ast.cast<ast::top_level_ast>()->insts[1].get();
+    ast = reparse(std::move(ast), {t2.begin(), t2.end()}, f);
+    auto fresh = parse({t2.begin(), t2.end()}, f);
+    if (h.errors || h.warnings || !ast || !(ast == fresh)) return false;
+    auto const& insts = ast.cast<ast::top_level_ast>()->insts;
+    auto const& fresh_insts = fresh.cast<ast::top_level_ast>()->insts;
+    auto m = insts[2].cast<ast::module_ast>(), fresh_m = fresh_insts[2].cast<ast::module_ast>();
+    return insts[0].get() == old_f && insts[1].get() != old_g && m == old_m && m->loc == fresh_m->loc && m->insts[0].loc() == fresh_m->insts[0].loc();
+  }
+  // an edit within a line doesn't move anything, but reused lazy bodies still have to point at the new tokens
+  bool incremental_lazy() {
+    quiet_handler_t h;
+    auto f = flags;
+    f.onerror = h;
+    f.lazy_bodies = true;
+    auto t1 = tokenize(R"(fn f(): i32 = {let a = 1; a + 2};
+fn g(): i32 = 3;)", sstring::get("<test>"), f);
+    auto t2 = tokenize(R"(fn f(): i32 = {let a = 1; a + 2};
+fn g(): i32 = 4;)", sstring::get("<test>"), f);
+    auto ast = parse({t1.begin(), t1.end()}, f);
+    if (!ast) return false;
+    auto old_f = ast.cast<ast::top_level_ast>()->insts[0].get();
+    f.lazy_bodies = false;
+    ast = reparse(std::move(ast), {t2.begin(), t2.end()}, f);
+    for (auto& tok : t1) tok.data = "}"; // anything still reading the old tokens would fail to parse
+    if (h.errors || h.warnings || !ast) return false;
+    auto fn = ast.cast<ast::top_level_ast>()->insts[0].dyn_cast<ast::fndef_ast>();
+    if (fn != old_f || fn->body_parsed()) return false;
+    auto fresh = parse({t2.begin(), t2.end()}, f);
+    return fn->get_body().dyn_cast<ast::block_ast>() && ast == fresh && !h.errors;
+  }
+  // records the kind of every node it's dispatched, and whether the overload that was picked matches it
+  struct kind_visitor : ast::visitor<kind_visitor> {
+    std::vector<ast::ast_base::kind_t> seen;
+    bool ok = true;
+    template <class T> void check(T const& n) {
+      seen.push_back(n.kind);
+      ok &= T::classof(&n);
+      ast::for_each_child(static_cast<ast::ast_base const&>(n), [this] (AST const& child) {(*this)(child);});
+    }
+    void visit_null() {}
+    void visit_node(ast::top_level_ast const& n) {check(n);}
+    void visit_node(ast::group_ast const& n) {check(n);}
+    void visit_node(ast::block_ast const& n) {check(n);}
+    void visit_node(ast::if_ast const& n) {check(n);}
+    void visit_node(ast::while_ast const& n) {check(n);}
+    void visit_node(ast::for_ast const& n) {check(n);}
+    void visit_node(ast::binop_ast const& n) {check(n);}
+    void visit_node(ast::unop_ast const& n) {check(n);}
+    void visit_node(ast::cast_ast const& n) {check(n);}
+    void visit_node(ast::call_ast const& n) {check(n);}
+    void visit_node(ast::subscr_ast const& n) {check(n);}
+    void visit_node(ast::member_ast const& n) {check(n);}
+    void visit_node(ast::fndef_ast const& n) {check(n);}
+    void visit_node(ast::null_ast const& n) {check(n);}
+    void visit_node(ast::integer_ast const& n) {check(n);}
+    void visit_node(ast::float_ast const& n) {check(n);}
+    void visit_node(ast::string_ast const& n) {check(n);}
+    void visit_node(ast::char_ast const& n) {check(n);}
+    void visit_node(ast::module_ast const& n) {check(n);}
+    void visit_node(ast::import_ast const& n) {check(n);}
+    void visit_node(ast::vardef_ast const& n) {check(n);}
+    void visit_node(ast::mutdef_ast const& n) {check(n);}
+    void visit_node(ast::varget_ast const& n) {check(n);}
+    void visit_node(ast::structdef_ast const& n) {check(n);}
+  };
+  bool visitor() {
+    using ast::ast_base;
+    auto loc = DEF_LOC(1, 1);
+    auto var = [&] (char const* name) {return AST::create<ast::varget_ast>(loc, sstring::get(name));};
+    auto body = AST::create<ast::block_ast>(loc, make_ast_vector({
+      AST::create<ast::if_ast>(loc, var("a"), AST::create<ast::while_ast>(loc, var("a"), AST::create<ast::for_ast>(loc, sstring::get("x"), var("xs"), AST::create<ast::null_ast>(loc))), AST::create<ast::string_ast>(loc, "s", sstring::get(""))),
+      AST::create<ast::binop_ast>(loc, OP_PLUS, AST::create<ast::unop_ast>(loc, OP_MINUS, AST::create<ast::integer_ast>(loc, llvm::APInt(64, 1), sstring::get(""))), AST::create<ast::cast_ast>(loc, sstring::get("i64"), AST::create<ast::float_ast>(loc, 1.5, sstring::get("")))),
+      AST::create<ast::subscr_ast>(loc, AST::create<ast::call_ast>(loc, var("f"), make_ast_vector({AST::create<ast::char_ast>(loc, "c", sstring::get(""))})), make_ast_vector({AST::create<ast::member_ast>(loc, var("s"), sstring::get("i"))}))
+    }));
+    auto tree = AST::create<ast::top_level_ast>(loc, make_ast_vector({
+      AST::create<ast::module_ast>(loc, "m", make_ast_vector({AST::create<ast::group_ast>(loc, make_ast_vector({AST::create<ast::import_ast>(loc, "x.y")}))})),
+      AST::create<ast::structdef_ast>(loc, sstring::get("s"), std::vector<ast::structdef_ast::field>{{sstring::get("i"), sstring::get("i64"), {}}}, std::vector<std::string>{}),
+      AST::create<ast::mutdef_ast>(loc, sstring::get("a"), AST::create<ast::integer_ast>(loc, llvm::APInt(64, 0), sstring::get("")), true),
+      AST::create<ast::vardef_ast>(loc, sstring::get("b"), AST::create<ast::fndef_ast>(loc, sstring::get("f"), sstring::get("i64"), std::vector<std::pair<sstring, sstring>>{}, std::move(body), std::vector<std::string>{}), true)
+    }));
+    kind_visitor v;
+    v(tree);
+    if (!v.ok || v.seen.size() != 29 || v.seen.front() != ast_base::kind_t::TOP_LEVEL) return false;
+    // every kind is dispatched at least once
+    for (int k = 0; k <= static_cast<int>(ast_base::kind_t::MEMBER); ++k) if (std::find(v.seen.begin(), v.seen.end(), static_cast<ast_base::kind_t>(k)) == v.seen.end()) return false;
+    return true;
+  }
 }
 #endif
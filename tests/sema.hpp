@@ -0,0 +1,160 @@
+#ifndef COBALT_TESTS_SEMA_HPP
+#define COBALT_TESTS_SEMA_HPP
+#include "cobalt/tokenizer.hpp"
+#include "cobalt/parser.hpp"
+#include "cobalt/sema.hpp"
+#include "cobalt/fold.hpp"
+#include "cobalt/ast.hpp"
+#include "cobalt/types.hpp"
+namespace tests::sema {
+  using namespace cobalt;
+  flags_t flags = default_flags;
+  bool annotate() {
+    quiet_handler_t h;
+    flags.onerror = h;
+    auto toks = tokenize(R"(let x = 1;
+fn f(a: f64): f64 = {let b = a; b + x};
+module m {let y = 'c';};
+let z = m.y;
+let w = f(1.5);)", sstring::get("<test>"), flags);
+    auto ast = parse({toks.begin(), toks.end()}, flags);
+    base_context ctx{new varmap, flags};
+    cobalt::annotate(ast, ctx);
+    if (h.errors || h.warnings || !ctx.vars->symbols.empty()) return false;
+    auto const& insts = ast.cast<ast::top_level_ast>()->insts;
+    if (insts.size() != 5) return false;
+    auto i64 = types::integer::get(64), i32 = types::integer::get(32);
+    auto f = insts[1].dyn_cast<ast::fndef_ast>();
+    auto z = insts[3].dyn_cast<ast::vardef_ast>(), w = insts[4].dyn_cast<ast::vardef_ast>();
+    if (!f || !z || !w || !insts[0].get()->annotated) return false;
+    auto body = f->body.dyn_cast<ast::block_ast>();
+    return
+      insts[0].type(ctx) == types::reference::get(i64) &&
+      body && body->annotated && body->cached_type == types::float64::get() &&
+      z->val.get()->annotated && z->val.type(ctx) == types::reference::get(i32) &&
+      w->val.type(ctx) == types::float64::get();
+  }
+  bool scopes() {
+    symbol_table locals;
+    auto x = sstring::get("x"), y = sstring::get("y");
+    type_ptr i32 = types::integer::get(32), f64 = types::float64::get();
+    auto type_of = [&] (sstring name) -> type_ptr {auto ptr = locals.get(name); return ptr && ptr->index() == 0 ? std::get<0>(*ptr).type : nullptr;};
+    locals.push_scope();
+    if (!locals.insert(x, typed_value{nullptr, i32}) || locals.insert(x, typed_value{nullptr, f64})) return false;
+    locals.push_scope();
+    if (!locals.insert(x, typed_value{nullptr, f64}) || !locals.insert(y, typed_value{nullptr, f64})) return false;
+    if (type_of(x) != f64 || type_of(y) != f64) return false;
+    locals.pop_scope();
+    if (type_of(x) != i32 || locals.get(y)) return false;
+    locals.pop_scope();
+    return !locals.get(x) && locals.undo.empty();
+  }
+  bool glob_imports() {
+    auto x = sstring::get("x"), y = sstring::get("y");
+    type_ptr i32 = types::integer::get(32), f64 = types::float64::get();
+    auto a = std::make_shared<varmap>(), b = std::make_shared<varmap>();
+    a->insert(x, typed_value{nullptr, i32});
+    b->insert(x, typed_value{nullptr, f64});
+    b->insert(y, typed_value{nullptr, f64});
+    varmap vm;
+    if (!vm.import(a).empty() || !vm.symbols.empty()) return false;
+    auto res = vm.import(b);
+    if (res.size() != 1 || !res.contains(x)) return false;
+    auto ptr = vm.get(x);
+    if (!ptr || std::get<0>(*ptr).type != i32 || !vm.get(y)) return false;
+    symbol_table locals;
+    locals.push_scope();
+    locals.insert(y, typed_value{nullptr, i32});
+    if (locals.import(b).size() != 1) return false;
+    locals.push_scope();
+    locals.import(a);
+    if (!(ptr = locals.get(x)) || std::get<0>(*ptr).type != i32) return false;
+    locals.pop_scope();
+    return (ptr = locals.get(x)) && std::get<0>(*ptr).type == f64 && locals.imports.size() == 1;
+  }
+  // glob imports are views of the imported module, so they see what it gains later
+  bool late_imports() {
+    auto x = sstring::get("x"), y = sstring::get("y"), z = sstring::get("z");
+    type_ptr i32 = types::integer::get(32), f64 = types::float64::get();
+    auto b = std::make_shared<varmap>(), c = std::make_shared<varmap>();
+    b->insert(x, typed_value{nullptr, f64});
+    varmap vm;
+    vm.insert(y, typed_value{nullptr, i32});
+    vm.import(b);
+    vm.import(c);
+    // defining an imported name here is a conflict, like it was already defined
+    auto [sym, succ] = vm.emplace(x, typed_value{nullptr, i32});
+    if (succ || sym != b->get(x) || std::get<0>(*vm.get(x)).type != f64) return false;
+    // names added to b after the import are visible, but don't shadow ours, and the first import wins
+    b->insert(y, typed_value{nullptr, f64});
+    c->insert(z, typed_value{nullptr, i32});
+    b->insert(z, typed_value{nullptr, f64});
+    return std::get<0>(*vm.get(y)).type == i32 && std::get<0>(*vm.get(z)).type == f64 && !vm.symbols.contains(z);
+  }
+  bool qualified_names() {
+    auto path = qpath::get(sstring::get(".m.n.x"));
+    if (path != qpath::get(sstring::get(".m.n.x")) || !path->absolute || path->segments.size() != 3 || path->segments[1] != sstring::get("n") || path->prefix_size(2) != 4) return false;
+    type_ptr i32 = types::integer::get(32), f64 = types::float64::get();
+    base_context ctx(new varmap);
+    std::size_t fail = 0;
+    if (ctx.resolve(*path, &fail) || fail != 2) return false;
+    auto m = std::make_shared<varmap>(ctx.vars), n = std::make_shared<varmap>(m.get());
+    ctx.vars->insert(sstring::get("m"), m);
+    m->insert(sstring::get("n"), n);
+    if (ctx.resolve(*path, &fail) || fail != 6) return false;
+    n->insert(sstring::get("x"), typed_value{nullptr, i32});
+    auto ptr = ctx.resolve(*path);
+    if (!ptr || ptr != ctx.resolve("m.n.x") || ctx.resolve_cache.size() != 2) return false;
+    // a local named m shadows the module, and isn't cached
+    ctx.locals.push_scope();
+    ctx.locals.insert(sstring::get("m"), typed_value{nullptr, f64});
+    if (ctx.resolve(*path) != ptr || ctx.resolve("m.n.x", &fail) || fail != 1 || ctx.resolve_cache.size() != 2) return false;
+    ctx.locals.pop_scope();
+    return ctx.resolve("m.n.x") == ptr;
+  }
+  // a cutoff hides what its tree gained later, other trees are unaffected, and cached lookups are kept for each cutoff
+  bool cutoffs() {
+    auto x = sstring::get("x"), y = sstring::get("y");
+    type_ptr i32 = types::integer::get(32);
+    base_context ctx(new varmap);
+    varmap other;
+    ctx.vars->insert(x, typed_value{nullptr, i32});
+    auto cut = ctx.vars->now();
+    ctx.vars->insert(y, typed_value{nullptr, i32});
+    other.insert(y, typed_value{nullptr, i32});
+    if (!ctx.vars->get(x, cut) || ctx.vars->get(y, cut) || !other.get(y, cut) || other.now().clock == cut.clock) return false;
+    if (!ctx.resolve(y)) return false;
+    ctx.visible = cut;
+    if (ctx.resolve(y) || !ctx.resolve(x)) return false;
+    ctx.visible = {};
+    return ctx.resolve(y) && ctx.resolve_cache.size() == 2;
+  }
+  bool folding() {
+    quiet_handler_t h;
+    flags.onerror = h;
+    auto toks = tokenize(R"(let a = 1 + 2 * 3;
+fn f(x: i64): i64 = x * 1;
+fn g(): i64 = {let k = 4; k + a};
+let d = 1 / 0;)", sstring::get("<test>"), flags);
+    auto ast = parse({toks.begin(), toks.end()}, flags);
+    base_context ctx{new varmap, flags};
+    cobalt::annotate(ast, ctx);
+    cobalt::fold(ast, ctx);
+    if (h.errors || h.warnings) return false;
+    auto const& insts = ast.cast<ast::top_level_ast>()->insts;
+    if (insts.size() != 4) return false;
+    auto a = insts[0].dyn_cast<ast::vardef_ast>(), d = insts[3].dyn_cast<ast::vardef_ast>();
+    auto f = insts[1].dyn_cast<ast::fndef_ast>(), g = insts[2].dyn_cast<ast::fndef_ast>();
+    if (!a || !d || !f || !g) return false;
+    auto seven = a->val.dyn_cast<ast::integer_ast>();
+    auto body = g->body.dyn_cast<ast::block_ast>();
+    if (!seven || seven->val != 7 || !seven->suffix.empty() || !body || body->insts.size() != 2) return false;
+    // k + a uses both constants, and takes its type from k
+    auto sum = body->insts[1].dyn_cast<ast::integer_ast>();
+    return
+      sum && sum->val == 11 && sum->type(ctx) == types::integer::get(64) &&
+      f->body.dyn_cast<ast::varget_ast>() &&
+      d->val.dyn_cast<ast::binop_ast>();
+  }
+}
+#endif
@@ -0,0 +1,29 @@
+#ifndef COBALT_TESTS_SERIALIZE_HPP
+#define COBALT_TESTS_SERIALIZE_HPP
+#include "cobalt/tokenizer.hpp"
+#include "cobalt/parser.hpp"
+#include "cobalt/serialize.hpp"
+#include "cobalt/ast.hpp"
+namespace tests::serialize {
+  using namespace cobalt;
+  flags_t flags = default_flags;
+  bool roundtrip() {
+    quiet_handler_t h;
+    flags.onerror = h;
+    auto toks = tokenize(R"(module x.y {
+  import a.b;
+  @link(external) fn f(a: i32, b: f64*): u8 = {let c = -a * 123456789012345678901234567890; b; "str"; 'c'; 1.5};
+  mut m = null;
+})", sstring::get("<test>"), flags);
+    auto ast = parse({toks.begin(), toks.end()}, flags);
+    std::string buf;
+    llvm::raw_string_ostream os(buf);
+    cobalt::serialize(ast, os);
+    os.flush();
+    auto loaded = deserialize(buf, flags);
+    if (h.errors || h.warnings || !loaded || !(loaded == ast)) return false;
+    deserialize(std::string_view(buf).substr(0, buf.size() - 1), flags);
+    return h.errors == 1;
+  }
+}
+#endif
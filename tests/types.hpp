@@ -0,0 +1,110 @@
+#ifndef COBALT_TESTS_TYPES_HPP
+#define COBALT_TESTS_TYPES_HPP
+#include "cobalt/types.hpp"
+#include <thread>
+namespace tests::types {
+  using namespace cobalt;
+  using namespace cobalt::types;
+  // every thread interns the same types, they should all get the same instances
+  bool interning() {
+    constexpr std::size_t nthreads = 4, ntypes = 200;
+    std::vector<std::vector<type_ptr>> results(nthreads);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < nthreads; ++t) threads.emplace_back([&out = results[t]] {
+      for (unsigned i = 0; i < ntypes; ++i) {
+        auto it = integer::get(i, i % 2);
+        out.push_back(it);
+        out.push_back(pointer::get(it));
+        out.push_back(reference::get(pointer::get(it)));
+        out.push_back(function::get(it, {float64::get(), it}));
+      }
+    });
+    for (auto& t : threads) t.join();
+    for (std::size_t t = 1; t < nthreads; ++t) if (results[t] != results[0]) return false;
+    auto fn = static_cast<function const*>(results[0][3]);
+    return integer::get(7, true)->nbits == -7 && integer::get(300) == integer::get(300) && fn->ret == integer::get(0) && fn->args == std::vector<type_ptr>{float64::get(), integer::get(0)};
+  }
+  bool names() {
+    auto i32 = integer::get(32), u8 = integer::get(8, true);
+    auto fn = function::get(float64::get(), {i32, reference::get(u8)});
+    if (i32->name() != sstring::get("i32") || u8->name() != sstring::get("u8") || pointer::get(u8)->name() != sstring::get("u8*") || fn->name() != sstring::get("f64(i32, u8&)")) return false;
+    return fn->hash() != function::get(float64::get(), {i32, pointer::get(u8)})->hash() && pointer::get(i32)->hash() != reference::get(i32)->hash() && u8->hash() != integer::get(8)->hash();
+  }
+  bool structs() {
+    std::vector<std::pair<sstring, type_ptr>> fs = {{sstring::get("a"), integer::get(8)}, {sstring::get("b"), integer::get(64)}, {sstring::get("c"), integer::get(16)}};
+    auto c = struct_::get(sstring::get("S"), fs, struct_::C), e = struct_::get(sstring::get("S"), fs), p = struct_::get(sstring::get("S"), fs, struct_::PACKED);
+    if (c->size() != 24 || c->align() != 8 || e->size() != 16 || e->align() != 8 || p->size() != 11 || p->align() != 1) return false;
+    // fields keep their declaration order, only the offsets change
+    auto f = e->get_field(sstring::get("a"));
+    return c != e && e == struct_::get(sstring::get("S"), fs) && f == &e->fields[0] && f->offset == 10 && c->fields[2].offset == 16 && struct_::field_type(reference::get(e), sstring::get("b")) == reference::get(integer::get(64));
+  }
+  bool hot_cold() {
+    std::vector<struct_::field_spec> fs = {{sstring::get("a"), integer::get(8), struct_::HOT}, {sstring::get("b"), integer::get(64), struct_::COLD}, {sstring::get("c"), integer::get(32)}, {sstring::get("d"), integer::get(64), struct_::COLD}};
+    auto s = struct_::get(sstring::get("H"), fs);
+    if (!s->cold || s->cold->size() != 16 || s->cold_index() != 1) return false;
+    // the hot field starts the cache line, followed by the cold pointer and then the normal field
+    return s->size() == struct_::cache_line && s->align() == struct_::cache_line && s->get_field(sstring::get("a"))->offset == 0 && s->get_field(sstring::get("c"))->offset == 16 && s->get_field(sstring::get("d"))->offset == 8 && s->get_field(sstring::get("d"))->index == 1;
+  }
+  bool soa_columns() {
+    auto s = struct_::get(sstring::get("V"), std::vector<std::pair<sstring, type_ptr>>{{sstring::get("x"), float32::get()}, {sstring::get("n"), integer::get(8)}, {sstring::get("y"), float32::get()}});
+    auto xs = soa::get(s);
+    // columns stay in declaration order, regardless of the element's layout
+    return xs == soa::get(s) && xs->name() == sstring::get("soa[V]") && xs->size() == 32 && soa::of(reference::get(xs)) == xs && !soa::of(s) && xs->column(s->get_field(sstring::get("y"))) == 2;
+  }
+  bool sum_types() {
+    type_ptr i8 = integer::get(8), i16 = integer::get(16), i64 = integer::get(64), nul = null::get();
+    auto t = tuple::get({i8, i64, i16});
+    if (t->size() != 16 || t->offsets != std::vector<std::size_t>{10, 0, 8}) return false;
+    // a null pointer, or a value past a narrow integer's width, can stand for the empty alternatives
+    auto p = variant::get({pointer::get(i8), nul}), b = variant::get({integer::get(1), nul}), u = variant::get({integer::get(8, true), nul});
+    if (p->repr != variant::NICHE || p->size() != 8 || b->repr != variant::NICHE || b->size() != 1 || b->niche_start != 2) return false;
+    if (u->repr != variant::TAGGED || u->size() != 2 || u->tag_offset() != 1) return false;
+    auto v = variant::get({i8, i64, float64::get()});
+    if (v->repr != variant::TAGGED || v->size() != 16 || v->tag_offset() != 8 || v->index_of(i8) != 2) return false;
+    std::vector<sstring> values;
+    for (int i = 0; i < 300; ++i) values.push_back(sstring::get("v" + std::to_string(i)));
+    if (tag_enum::get(sstring::get("E"), values)->size() != 2 || union_::get({i8, i64, i16})->size() != 8 || integer::get(24, true)->size() != 4) return false;
+    // the LLVM types have to take up the same space
+    compile_context ctx{"<test>"};
+    llvm::DataLayout dl("e-m:e-i64:64-f80:128-n8:16:32:64-S128");
+    auto llvm_size = [&] (type_ptr t) {return dl.getTypeAllocSize(t->llvm_type(nullloc, ctx)).getFixedSize();};
+    auto tag_only = variant::get({tuple::get({}), nul});
+    if (tag_only->repr != variant::TAGGED || tag_only->tag_offset() != 0) return false;
+    return llvm_size(union_::get({i8, i64, i16})) == 8 && llvm_size(v) == v->size() && llvm_size(tag_only) == tag_only->size() && llvm_size(t) == t->size();
+  }
+  bool vectors() {
+    auto v = vector::get(float32::get(), 8);
+    if (v != vector::get(float32::get(), 8) || v->name() != "f32x8" || v->size() != 32 || v->align() != 32) return false;
+    // odd widths are padded to a power of two
+    auto b = vector::get(integer::get(8), 3);
+    return b->size() == 4 && vector::of(reference::get(b)) == b && !vector::of(integer::get(8));
+  }
+  bool arrays() {
+    type_ptr i32 = integer::get(32);
+    auto a = array::get(i32, 4);
+    auto s = slice::get(i32);
+    if (a->name() != "i32[4]" || a->size() != 16 || a->align() != 4 || s->name() != "i32[]" || s->size() != 16) return false;
+    base_context ctx{new varmap};
+    if (!(ctx.parse_type(sstring::get("i32[4][]")) == slice::get(a) && ctx.parse_type(sstring::get("i32[][4]*")) == pointer::get(array::get(s, 4)) && sequence_field(reference::get(s), sstring::get("ptr")) == pointer::get(i32))) return false;
+    // builtin element types are cached for the session, names from a module until it changes, and local names aren't cached
+    auto t = sstring::get("T"), ts = sstring::get("T[4]*");
+    if (!ctx.type_cache.contains(sstring::get("i32[4][]"))) return false;
+    ctx.vars->insert(t, i32);
+    if (ctx.parse_type(ts) != pointer::get(array::get(i32, 4)) || ctx.type_cache.contains(ts) || ctx.scoped_type_cache.size() != 1) return false;
+    ctx.locals.push_scope();
+    ctx.locals.insert(t, types::float64::get());
+    if (ctx.parse_type(ts) != pointer::get(array::get(types::float64::get(), 4)) || ctx.scoped_type_cache.size() != 1) return false;
+    ctx.locals.pop_scope();
+    return ctx.parse_type(ts) == pointer::get(array::get(i32, 4));
+  }
+  bool optionals() {
+    type_ptr i8 = integer::get(8);
+    auto o = variant::optional(i8);
+    if (o->optional_of() != i8 || o->name() != "i8?" || o->repr != variant::TAGGED || !o->packed() || o->size() != 2 || o->index_of(null::get()) != 1) return false;
+    if (variant::optional(pointer::get(i8))->repr != variant::NICHE || variant::optional(integer::get(1))->repr != variant::NICHE) return false;
+    // an enum's values past the last one are free
+    auto e = variant::optional(tag_enum::get(sstring::get("E"), {sstring::get("a"), sstring::get("b"), sstring::get("c")}));
+    return e->repr == variant::NICHE && e->size() == 1 && e->niche_start == 3 && !variant::get({i8, integer::get(64), null::get()})->optional_of();
+  }
+}
+#endif